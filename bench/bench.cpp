@@ -0,0 +1,622 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <new>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#include "corpus.tt.h"
+#include "type_titan.util.h"
+#include "type_titan.compact.h"
+
+#include "../examples/print.h"
+#include "../examples/json_serializer.h"
+
+// Every allocation made through `new` is counted so we can report allocations per operation,
+// this includes `Any` and `AnyVector` which use the `std::nothrow` version
+static std::atomic<uint64_t> allocation_count(0);
+static std::atomic<uint64_t> allocation_bytes(0);
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    allocation_count += 1;
+    allocation_bytes += size;
+
+    return malloc(size ? size : 1);
+}
+
+void* operator new(size_t size) {
+    void* ptr = operator new(size, std::nothrow);
+    if (!ptr) throw std::bad_alloc();
+
+    return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;
+    double ns_per_op;
+    double allocations_per_op;
+    double bytes_per_op;
+};
+
+static std::vector<BenchResult> results;
+static const char* filter = nullptr;
+
+// Results are added to this so the compiler can't throw the benchmarked code away
+static volatile uint64_t sink = 0;
+
+// Runs `func` `iterations` times, `ops_per_iteration` is used for benchmarks that do a batch per call
+template<typename F>
+static void run_bench(const char* name, uint64_t iterations, F func, uint64_t ops_per_iteration = 1) {
+    if (filter && !strstr(name, filter)) return;
+
+    // Warm up first so lazy type info initialization isn't measured
+    for (uint64_t i = 0; i < iterations / 10 + 1; i++) {
+        func(i);
+    }
+
+    uint64_t allocations_before = allocation_count.load();
+    uint64_t bytes_before = allocation_bytes.load();
+    auto start = std::chrono::steady_clock::now();
+
+    for (uint64_t i = 0; i < iterations; i++) {
+        func(i);
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    double ops = (double)(iterations * ops_per_iteration);
+
+    BenchResult result;
+    result.name = name;
+    result.iterations = iterations * ops_per_iteration;
+    result.ns_per_op = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / ops;
+    result.allocations_per_op = (double)(allocation_count.load() - allocations_before) / ops;
+    result.bytes_per_op = (double)(allocation_bytes.load() - bytes_before) / ops;
+    results.push_back(result);
+
+    fprintf(stderr, "%-36s %12.2f ns/op %10.2f allocs/op %10.2f bytes/op\n",
+            name, result.ns_per_op, result.allocations_per_op, result.bytes_per_op);
+}
+
+static bool write_results(const char* path) {
+    FILE* file = fopen(path, "w");
+    if (!file) return false;
+
+    fprintf(file, "{\n  \"timestamp\": %lld,\n  \"benchmarks\": [\n", (long long)time(nullptr));
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        fprintf(file,
+                "    { \"name\": \"%s\", \"iterations\": %llu, \"ns_per_op\": %.3f, "
+                "\"allocations_per_op\": %.3f, \"bytes_per_op\": %.3f }%s\n",
+                r.name.c_str(), (unsigned long long)r.iterations, r.ns_per_op,
+                r.allocations_per_op, r.bytes_per_op, (i + 1 < results.size()) ? "," : "");
+    }
+
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+static void bench_lookups() {
+    run_bench("type_of/small", 10000000, [](uint64_t) {
+        sink += (uintptr_t)tt::type_of<bench::Small>();
+    });
+
+    run_bench("type_of/wide", 10000000, [](uint64_t) {
+        sink += (uintptr_t)tt::type_of<bench::Wide>();
+    });
+
+    run_bench("get_field/small/first", 10000000, [](uint64_t) {
+        sink += (uintptr_t)tt::get_field<bench::Small>("id");
+    });
+
+    run_bench("get_field/wide/last", 1000000, [](uint64_t) {
+        sink += (uintptr_t)tt::get_field<bench::Wide>("f77");
+    });
+
+    run_bench("has_tag/small/hit", 10000000, [](uint64_t) {
+        sink += tt::has_tag<bench::Small>("Hot");
+    });
+
+    run_bench("has_tag/overloaded/miss", 10000000, [](uint64_t) {
+        sink += tt::has_tag<bench::Overloaded>("Z");
+    });
+
+    run_bench("get_enum_name/big/first", 10000000, [](uint64_t) {
+        sink += (uintptr_t)tt::get_enum_name(bench::BigEnum::Value000);
+    });
+
+    run_bench("get_enum_name/big/last", 100000, [](uint64_t) {
+        sink += (uintptr_t)tt::get_enum_name(bench::BigEnum::Value999);
+    });
+}
+
+static void bench_calls() {
+    bench::Overloaded overloaded;
+
+    run_bench("call_method/overloaded/first", 1000000, [&](uint64_t i) {
+        sink += tt::call_method<int32_t>(overloaded, "f", (int32_t)i);
+    });
+
+    run_bench("call_method/overloaded/last", 1000000, [&](uint64_t i) {
+        sink += tt::call_method<int32_t>(overloaded, "f", (int32_t)i, (int32_t)1, (int32_t)2);
+    });
+
+    run_bench("call_method/unique", 1000000, [&](uint64_t i) {
+        sink += tt::call_method<int32_t>(overloaded, "h", (int32_t)i);
+    });
+}
+
+static void bench_fields() {
+    bench::Small small = { 1, 2.0f };
+    bench::Wide wide = {};
+
+    run_bench("read_field/small", 10000000, [&](uint64_t) {
+        float value = 0.0f;
+        tt::read_field(small, "value", value);
+        sink += (uint64_t)value;
+    });
+
+    run_bench("write_field/small", 10000000, [&](uint64_t i) {
+        tt::write_field(small, "id", (int32_t)i);
+        sink += small.id;
+    });
+
+    run_bench("read_field/wide/last", 1000000, [&](uint64_t) {
+        int32_t value = 0;
+        tt::read_field(wide, "f77", value);
+        sink += value;
+    });
+
+    // Gathering one field out of many records versus reading it one record at a time
+    static const int PARTICLE_COUNT = 4096;
+    std::vector<bench::Particle> particles(PARTICLE_COUNT);
+    std::vector<float> masses(PARTICLE_COUNT);
+
+    for (int i = 0; i < PARTICLE_COUNT; i++) {
+        particles[i].mass = (float)i;
+    }
+
+    tt::RecordField* mass_field = tt::get_field<bench::Particle>("mass");
+
+    run_bench("gather_field/particles", 1000, [&](uint64_t) {
+        tt::gather_field(tt::Span<bench::Particle>(particles.data(), PARTICLE_COUNT), mass_field, masses.data());
+        sink += (uint64_t)masses[PARTICLE_COUNT - 1];
+    }, PARTICLE_COUNT);
+
+    run_bench("read_field_loop/particles", 1000, [&](uint64_t) {
+        for (int i = 0; i < PARTICLE_COUNT; i++) {
+            tt::read_field(particles[i], mass_field, masses[i]);
+        }
+
+        sink += (uint64_t)masses[PARTICLE_COUNT - 1];
+    }, PARTICLE_COUNT);
+
+    run_bench("scatter_field/particles", 1000, [&](uint64_t) {
+        tt::scatter_field(tt::Span<bench::Particle>(particles.data(), PARTICLE_COUNT), mass_field, masses.data());
+        sink += (uint64_t)particles[PARTICLE_COUNT - 1].mass;
+    }, PARTICLE_COUNT);
+
+    run_bench("write_field_loop/particles", 1000, [&](uint64_t) {
+        for (int i = 0; i < PARTICLE_COUNT; i++) {
+            tt::write_field(particles[i], mass_field, masses[i]);
+        }
+
+        sink += (uint64_t)particles[PARTICLE_COUNT - 1].mass;
+    }, PARTICLE_COUNT);
+
+    // Strings can't be copied bytewise, they have to go through the field accessors
+    static const int PROFILE_COUNT = 64;
+    std::vector<bench::Profile> profiles(PROFILE_COUNT);
+    std::vector<std::string> names(PROFILE_COUNT);
+
+    for (int i = 0; i < PROFILE_COUNT; i++) {
+        profiles[i].name = "a name that doesn't fit in the small string buffer " + std::to_string(i);
+    }
+
+    tt::RecordField* name_field = tt::get_field<bench::Profile>("name");
+    tt::Span<bench::Profile> profile_span(profiles.data(), PROFILE_COUNT);
+
+    run_bench("gather_field/profiles/name", 1000, [&](uint64_t) {
+        tt::gather_field(profile_span, name_field, names.data());
+        sink += names[PROFILE_COUNT - 1].size();
+    }, PROFILE_COUNT);
+
+    run_bench("scatter_field/profiles/name", 1000, [&](uint64_t) {
+        tt::scatter_field(profile_span, name_field, names.data());
+        sink += profiles[PROFILE_COUNT - 1].name.size();
+    }, PROFILE_COUNT);
+
+    // Checked outside of the benchmarks, which don't run when they're filtered out
+    std::string name;
+    bool copied = tt::gather_field(profile_span, name_field, names.data()) && names[PROFILE_COUNT - 1] == profiles[PROFILE_COUNT - 1].name &&
+                  tt::read_field(profiles[1], name_field, name) && name == profiles[1].name &&
+                  tt::write_field(profiles[0], name_field, name) && profiles[0].name == name &&
+                  !tt::gather_field(profile_span, name_field, masses.data(), tt::ReadWritePolicy::Raw);
+
+    if (!copied) {
+        fprintf(stderr, "gather_field/profiles/name: the strings weren't copied through the accessors\n");
+        exit(1);
+    }
+}
+
+// Reads a primitive as a double the way the examples used to, by comparing type ids
+static double read_by_type_id(const tt::TypeInfo* ti, const void* data) {
+    if (ti->type_id == tt::type_of<bool>()->type_id) return *(const bool*)data;
+    if (ti->type_id == tt::type_of<int8_t>()->type_id) return *(const int8_t*)data;
+    if (ti->type_id == tt::type_of<int16_t>()->type_id) return *(const int16_t*)data;
+    if (ti->type_id == tt::type_of<int32_t>()->type_id) return *(const int32_t*)data;
+    if (ti->type_id == tt::type_of<int64_t>()->type_id) return (double)*(const int64_t*)data;
+    if (ti->type_id == tt::type_of<uint8_t>()->type_id) return *(const uint8_t*)data;
+    if (ti->type_id == tt::type_of<uint16_t>()->type_id) return *(const uint16_t*)data;
+    if (ti->type_id == tt::type_of<uint32_t>()->type_id) return *(const uint32_t*)data;
+    if (ti->type_id == tt::type_of<uint64_t>()->type_id) return (double)*(const uint64_t*)data;
+    if (ti->type_id == tt::type_of<float>()->type_id) return *(const float*)data;
+    if (ti->type_id == tt::type_of<double>()->type_id) return *(const double*)data;
+
+    return 0.0;
+}
+
+static double read_by_primitive_kind(const tt::TypeInfo* ti, const void* data) {
+    switch (ti->primitive_kind) {
+        case tt::PrimitiveKind::Bool: return *(const bool*)data;
+        case tt::PrimitiveKind::I8: return *(const int8_t*)data;
+        case tt::PrimitiveKind::I16: return *(const int16_t*)data;
+        case tt::PrimitiveKind::I32: return *(const int32_t*)data;
+        case tt::PrimitiveKind::I64: return (double)*(const int64_t*)data;
+        case tt::PrimitiveKind::U8: return *(const uint8_t*)data;
+        case tt::PrimitiveKind::U16: return *(const uint16_t*)data;
+        case tt::PrimitiveKind::U32: return *(const uint32_t*)data;
+        case tt::PrimitiveKind::U64: return (double)*(const uint64_t*)data;
+        case tt::PrimitiveKind::F32: return *(const float*)data;
+        case tt::PrimitiveKind::F64: return *(const double*)data;
+        default: return 0.0;
+    }
+}
+
+static void bench_primitives() {
+    // Every field of an entity is a different primitive, so both ways see a mix of early and late matches
+    bench::Entity entity = { 1, 1.0f, 2.0f, 3.0f, 100, 30, 1, true, 0.0 };
+    const tt::TypeInfoRecord* record = tt::cast<tt::TypeInfoRecord>(tt::type_of<bench::Entity>());
+
+    run_bench("read_primitive/type_id", 1000000, [&](uint64_t) {
+        double sum = 0.0;
+
+        for (int i = 0; i < record->field_count; i++) {
+            sum += read_by_type_id(record->fields[i].type_info, (const uint8_t*)&entity + record->fields[i].offset);
+        }
+
+        sink += (uint64_t)sum;
+    }, record->field_count);
+
+    run_bench("read_primitive/primitive_kind", 1000000, [&](uint64_t) {
+        double sum = 0.0;
+
+        for (int i = 0; i < record->field_count; i++) {
+            sum += read_by_primitive_kind(record->fields[i].type_info, (const uint8_t*)&entity + record->fields[i].offset);
+        }
+
+        sink += (uint64_t)sum;
+    }, record->field_count);
+}
+
+// Checks inheritance the way it had to be done before the hierarchy tables, by recursing over the parents
+static bool is_a_by_parents(const tt::TypeInfo* ti, const tt::TypeInfo* base) {
+    if (ti->type_id == base->type_id) return true;
+
+    for (const tt::TypeInfo* parent : tt::get_parents(ti)) {
+        if (is_a_by_parents(parent, base)) return true;
+    }
+
+    return false;
+}
+
+static void bench_hierarchy() {
+    // A hit at the bottom of the chain, a miss that has to visit every parent and a second parent
+    const tt::TypeInfo* key_down = tt::type_of<bench::KeyDownMessage>();
+    const tt::TypeInfo* recorded = tt::type_of<bench::RecordedKeyMessage>();
+    const tt::TypeInfo* message = tt::type_of<bench::Message>();
+    const tt::TypeInfo* timestamped = tt::type_of<bench::Timestamped>();
+
+    run_bench("is_a/parents/hit", 10000000, [&](uint64_t) {
+        sink += is_a_by_parents(key_down, message);
+    });
+
+    run_bench("is_a/hierarchy/hit", 10000000, [&](uint64_t) {
+        sink += tt::is_a(key_down, message);
+    });
+
+    run_bench("is_a/parents/miss", 10000000, [&](uint64_t) {
+        sink += is_a_by_parents(key_down, timestamped);
+    });
+
+    run_bench("is_a/hierarchy/miss", 10000000, [&](uint64_t) {
+        sink += tt::is_a(key_down, timestamped);
+    });
+
+    run_bench("is_a/parents/multiple", 10000000, [&](uint64_t) {
+        sink += is_a_by_parents(recorded, timestamped);
+    });
+
+    run_bench("is_a/hierarchy/multiple", 10000000, [&](uint64_t) {
+        sink += tt::is_a(recorded, timestamped);
+    });
+
+    bench::RecordedKeyMessage object = {};
+    run_bench("dyn_cast/multiple", 10000000, [&](uint64_t) {
+        sink += (uintptr_t)tt::dyn_cast<bench::Timestamped>(&object, recorded);
+    });
+
+    // The most-derived type through a base pointer, the way RTTI's `typeid` would find it
+    bench::Circle circle;
+    const bench::Shape* shape = &circle;
+    run_bench("type_of_dynamic/circle", 10000000, [&](uint64_t) {
+        sink += (uintptr_t)tt::type_of_dynamic(shape);
+    });
+
+    run_bench("typeid/circle", 10000000, [&](uint64_t) {
+        sink += typeid(*shape).hash_code();
+    });
+}
+
+// Copies every non-record field, the way a serializer has to without the leaf tables
+static void copy_recursive(const tt::TypeInfo* ti, uint8_t* dst, const uint8_t* src) {
+    auto parents = tt::get_parents(ti);
+    auto parent_offsets = tt::get_parent_offsets(ti);
+
+    for (int i = 0; i < parents.length(); i++) {
+        if (parent_offsets[i] != tt::UNKNOWN_OFFSET) {
+            copy_recursive(parents[i], dst + parent_offsets[i], src + parent_offsets[i]);
+        }
+    }
+
+    for (const tt::RecordField& field : tt::get_fields(ti)) {
+        if (field.type_info->type == tt::TypeInfoType::Record) {
+            copy_recursive(field.type_info, dst + field.offset, src + field.offset);
+        } else {
+            memcpy(dst + field.offset, src + field.offset, field.type_info->size);
+        }
+    }
+}
+
+static void bench_walkers() {
+    // Copying every field by walking the type info versus the compact tables
+    bench::Wide src = {};
+    bench::Wide dst = {};
+    src.f77 = 1;
+
+    const tt::TypeInfoRecord* record = tt::cast<tt::TypeInfoRecord>(tt::type_of<bench::Wide>());
+    const tt::CompactType* compact = tt::get_compact_type<bench::Wide>();
+
+    run_bench("walk_fields/record/wide", 1000000, [&](uint64_t) {
+        for (int i = 0; i < record->field_count; i++) {
+            const tt::RecordField& field = record->fields[i];
+            memcpy((uint8_t*)&dst + field.offset, (const uint8_t*)&src + field.offset, field.type_info->size);
+        }
+
+        sink += dst.f77;
+    });
+
+    run_bench("walk_fields/compact/wide", 1000000, [&](uint64_t) {
+        for (uint32_t i = 0; i < compact->field_count; i++) {
+            uint32_t field = compact->first_field + i;
+            uint32_t offset = tt::COMPACT_FIELD_OFFSETS[field];
+            memcpy((uint8_t*)&dst + offset, (const uint8_t*)&src + offset, tt::COMPACT_FIELD_SIZES[field]);
+        }
+
+        sink += dst.f77;
+    });
+
+    // Copying a nested record by recursing into its parents and record fields versus the flattened leaves
+    bench::Deep7 deep_src = {};
+    bench::Deep7 deep_dst = {};
+    deep_src.inner.inner.inner.inner.inner.inner.inner.value = 1;
+
+    const tt::TypeInfo* deep_ti = tt::type_of<bench::Deep7>();
+    const tt::CompactType* deep_compact = tt::get_compact_type<bench::Deep7>();
+
+    run_bench("walk_leaves/recursive/deep", 1000000, [&](uint64_t) {
+        copy_recursive(deep_ti, (uint8_t*)&deep_dst, (const uint8_t*)&deep_src);
+        sink += deep_dst.inner.inner.inner.inner.inner.inner.inner.value;
+    });
+
+    const uint32_t* leaf_offsets = tt::get_compact_leaf_offsets();
+
+    run_bench("walk_leaves/compact/deep", 1000000, [&](uint64_t) {
+        for (uint32_t i = 0; i < deep_compact->leaf_count; i++) {
+            uint32_t leaf = deep_compact->first_leaf + i;
+            uint32_t offset = leaf_offsets[leaf];
+            memcpy((uint8_t*)&deep_dst + offset, (const uint8_t*)&deep_src + offset, tt::COMPACT_LEAF_SIZES[leaf]);
+        }
+
+        sink += deep_dst.inner.inner.inner.inner.inner.inner.inner.value;
+    });
+}
+
+static void bench_containers() {
+    // Copying a vector out of a type-erased field one element at a time versus with the container thunks
+    bench::Samples samples;
+    samples.values.resize(1024, 1.0f);
+
+    const tt::RecordField* field = tt::get_field<bench::Samples>("values");
+    const tt::TypeInfoContainer* container = tt::cast<tt::TypeInfoContainer>(field->type_info);
+    std::vector<float> out(1024);
+
+    run_bench("container_copy/element/floats", 100000, [&](uint64_t) {
+        const std::vector<float>& values = *(const std::vector<float>*)((const uint8_t*)&samples + field->offset);
+
+        for (size_t i = 0; i < values.size(); i++) {
+            out[i] = (float)read_by_primitive_kind(container->underlying, &values[i]);
+        }
+
+        sink += (uint64_t)out[1023];
+    }, 1024);
+
+    run_bench("container_copy/bulk/floats", 100000, [&](uint64_t) {
+        void* values = (uint8_t*)&samples + field->offset;
+        size_t size = container->get_size(values);
+
+        memcpy(out.data(), container->get_data(values), size * container->underlying->size);
+        sink += (uint64_t)out[1023];
+    }, 1024);
+}
+
+static void bench_any() {
+    // Filling a type-erased vector through the trait flags (trivial) and the lifecycle thunks (strings and vectors)
+    static const int ELEMENT_COUNT = 1000;
+    bench::Particle particle = {};
+    bench::Samples samples;
+    samples.name = "a name that doesn't fit in the small string buffer";
+    samples.values.resize(16, 1.0f);
+
+    run_bench("vector_push/std/particles", 1000, [&](uint64_t) {
+        std::vector<bench::Particle> values;
+        for (int i = 0; i < ELEMENT_COUNT; i++) values.push_back(particle);
+
+        sink += values.size();
+    }, ELEMENT_COUNT);
+
+    run_bench("vector_push/any/particles", 1000, [&](uint64_t) {
+        tt::AnyVector values(tt::type_of<bench::Particle>());
+        for (int i = 0; i < ELEMENT_COUNT; i++) values.push_back(&particle);
+
+        sink += values.length();
+    }, ELEMENT_COUNT);
+
+    run_bench("vector_push/std/samples", 100, [&](uint64_t) {
+        std::vector<bench::Samples> values;
+        for (int i = 0; i < ELEMENT_COUNT; i++) values.push_back(samples);
+
+        sink += values.size();
+    }, ELEMENT_COUNT);
+
+    run_bench("vector_push/any/samples", 100, [&](uint64_t) {
+        tt::AnyVector values(tt::type_of<bench::Samples>());
+        for (int i = 0; i < ELEMENT_COUNT; i++) values.push_back(&samples);
+
+        sink += values.length();
+    }, ELEMENT_COUNT);
+}
+
+static void bench_diff() {
+    static const int ENTITY_COUNT = 100000;
+    std::vector<bench::Entity> before(ENTITY_COUNT);
+    std::vector<bench::Entity> after(ENTITY_COUNT);
+
+    for (int i = 0; i < ENTITY_COUNT; i++) {
+        before[i] = { (uint32_t)i, 1.0f, 2.0f, 3.0f, 100, 30, 1, true, 0.0 };
+        after[i] = before[i];
+
+        // Roughly what changes in a frame: position always, health sometimes
+        after[i].x += 0.5f;
+        if (i % 8 == 0) after[i].health -= 10;
+    }
+
+    std::vector<uint8_t> delta(tt::delta_max_size<bench::Entity>());
+
+    run_bench("diff/entities", 10, [&](uint64_t) {
+        for (int i = 0; i < ENTITY_COUNT; i++) {
+            sink += tt::diff(before[i], after[i], delta.data(), (int)delta.size());
+        }
+    }, ENTITY_COUNT);
+
+    int delta_size = tt::diff(before[0], after[0], delta.data(), (int)delta.size());
+
+    run_bench("apply/entities", 10, [&](uint64_t) {
+        for (int i = 0; i < ENTITY_COUNT; i++) {
+            sink += tt::apply(before[i], delta.data(), delta_size);
+        }
+    }, ENTITY_COUNT);
+
+    // Containers aren't part of the delta, their bytes point to heap memory owned by the source object
+    bench::Profile profile_before = { 1, "a name that doesn't fit in the small string buffer", 10.0f, { 1.0f, 2.0f } };
+    bench::Profile profile_after = profile_before;
+    profile_after.name = "another name that doesn't fit in the small string buffer";
+    profile_after.score = 20.0f;
+
+    std::vector<uint8_t> profile_delta(tt::delta_max_size<bench::Profile>());
+    int profile_delta_size = tt::diff(profile_before, profile_after, profile_delta.data(), (int)profile_delta.size());
+
+    bench::Profile replica = profile_before;
+    tt::apply(replica, profile_delta.data(), profile_delta_size);
+
+    if (replica.score != profile_after.score || replica.name != profile_before.name) {
+        fprintf(stderr, "apply/profile: the delta contains a container\n");
+        exit(1);
+    }
+
+    run_bench("diff/profile", 1000000, [&](uint64_t) {
+        sink += tt::diff(profile_before, profile_after, profile_delta.data(), (int)profile_delta.size());
+    });
+
+    run_bench("apply/profile", 1000000, [&](uint64_t) {
+        sink += tt::apply(replica, profile_delta.data(), profile_delta_size);
+    });
+}
+
+static void bench_serializers() {
+    // The example serializers write to stdout, so redirect it if you don't want to see the output
+    bench::Small small = { 1, 2.0f };
+    bench::Deep7 deep = {};
+
+    run_bench("print/small", 10000, [&](uint64_t) {
+        print(small);
+    });
+
+    run_bench("print/deep", 10000, [&](uint64_t) {
+        print(deep);
+    });
+
+    run_bench("json_serialize/small", 10000, [&](uint64_t) {
+        json_serialize(small);
+    });
+
+    run_bench("json_serialize/deep", 10000, [&](uint64_t) {
+        json_serialize(deep);
+    });
+
+    fflush(stdout);
+}
+
+int main(int argc, char** argv) {
+    const char* output_path = "bench_results.json";
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else {
+            output_path = argv[i];
+        }
+    }
+
+    bench_lookups();
+    bench_calls();
+    bench_fields();
+    bench_primitives();
+    bench_hierarchy();
+    bench_walkers();
+    bench_containers();
+    bench_any();
+    bench_diff();
+    bench_serializers();
+
+    if (!write_results(output_path)) {
+        fprintf(stderr, "failed to write '%s'\n", output_path);
+        return 1;
+    }
+
+    fprintf(stderr, "\nwrote %d results to '%s'\n", (int)results.size(), output_path);
+    return 0;
+}
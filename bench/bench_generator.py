@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+# Runs tt over synthetic corpora and reports how it scales
+#
+# usage: bench_generator.py <path to tt> [--output results.json] [--clang <args...>]
+#
+# Every sweep changes one parameter of gen_headers.py while keeping the others at their default,
+# so quadratic behavior shows up as a time that grows faster than the parameter.
+
+import argparse
+import json
+import os
+import re
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+SCRIPT_DIR = os.path.dirname(os.path.abspath(__file__))
+
+DEFAULTS = {
+    "files": 4,
+    "records": 20,
+    "fields": 8,
+    "template-params": 0,
+    "namespace-depth": 1,
+}
+
+SWEEPS = {
+    "files": [1, 4, 16, 64],
+    "records": [10, 40, 160, 640],
+    "fields": [4, 16, 64, 256],
+    "template-params": [0, 2, 8, 32],
+    "namespace-depth": [0, 4, 16, 64],
+}
+
+PHASE_PATTERN = re.compile(r"phase (\w+): ([0-9.e+-]+) seconds")
+PEAK_PATTERN = re.compile(r"peak memory: ([0-9.e+-]+) MiB")
+
+
+def run(tt, params, clang_args):
+    work_dir = tempfile.mkdtemp(prefix="tt_bench_")
+
+    try:
+        corpus_dir = os.path.join(work_dir, "corpus")
+        output_dir = os.path.join(work_dir, "out")
+        os.makedirs(output_dir)
+
+        gen_args = [sys.executable, os.path.join(SCRIPT_DIR, "gen_headers.py"), corpus_dir]
+        for key, value in params.items():
+            gen_args += ["--" + key, str(value)]
+        subprocess.check_call(gen_args)
+
+        tt_args = [tt, output_dir + "/", "-profile", os.path.join(corpus_dir, "*.h")]
+        if clang_args:
+            tt_args += ["-clang"] + clang_args
+
+        start = time.perf_counter()
+        result = subprocess.run(tt_args, stdout=subprocess.PIPE, stderr=subprocess.STDOUT, universal_newlines=True)
+        seconds = time.perf_counter() - start
+
+        if result.returncode != 0 or "contains errors" in result.stdout:
+            print(result.stdout)
+            raise RuntimeError("tt failed for {}".format(params))
+
+        phases = {name: float(value) for name, value in PHASE_PATTERN.findall(result.stdout)}
+        peak = PEAK_PATTERN.search(result.stdout)
+
+        return {
+            "params": dict(params),
+            "seconds": seconds,
+            "headers_per_second": params["files"] / seconds,
+            "phases": phases,
+            "peak_memory_mib": float(peak.group(1)) if peak else 0.0,
+        }
+    finally:
+        shutil.rmtree(work_dir, ignore_errors=True)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Benchmarks the generator")
+    parser.add_argument("tt")
+    parser.add_argument("--output", default="generator_results.json")
+    parser.add_argument("--sweep", choices=sorted(SWEEPS.keys()), help="only run one sweep")
+    parser.add_argument("--clang", nargs=argparse.REMAINDER, default=[], help="arguments passed to clang")
+    args = parser.parse_args()
+
+    results = []
+    sweeps = [args.sweep] if args.sweep else sorted(SWEEPS.keys())
+
+    for sweep in sweeps:
+        print("{}:".format(sweep))
+
+        for value in SWEEPS[sweep]:
+            params = dict(DEFAULTS)
+            params[sweep] = value
+
+            result = run(args.tt, params, args.clang)
+            result["sweep"] = sweep
+            results.append(result)
+
+            phases = "  ".join("{} {:.3f}".format(name, seconds) for name, seconds in sorted(result["phases"].items()))
+            print("  {:>5}: {:8.3f} s  {:8.1f} headers/s  {:7.1f} MiB  {}".format(
+                value, result["seconds"], result["headers_per_second"], result["peak_memory_mib"], phases))
+
+    with open(args.output, "w") as file:
+        json.dump({"timestamp": int(time.time()), "results": results}, file, indent=2)
+
+    print("\nwrote {} results to '{}'".format(len(results), args.output))
+
+
+if __name__ == "__main__":
+    main()
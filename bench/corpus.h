@@ -0,0 +1,185 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Synthetic types for the runtime benchmarks, see bench.cpp
+
+#define BENCH_FIELDS_8(type, p) type p##0; type p##1; type p##2; type p##3; type p##4; type p##5; type p##6; type p##7;
+#define BENCH_FIELDS_64(type, p) \
+    BENCH_FIELDS_8(type, p##0) BENCH_FIELDS_8(type, p##1) BENCH_FIELDS_8(type, p##2) BENCH_FIELDS_8(type, p##3) \
+    BENCH_FIELDS_8(type, p##4) BENCH_FIELDS_8(type, p##5) BENCH_FIELDS_8(type, p##6) BENCH_FIELDS_8(type, p##7)
+
+#define BENCH_VALUES_10(p) p##0, p##1, p##2, p##3, p##4, p##5, p##6, p##7, p##8, p##9,
+#define BENCH_VALUES_100(p) \
+    BENCH_VALUES_10(p##0) BENCH_VALUES_10(p##1) BENCH_VALUES_10(p##2) BENCH_VALUES_10(p##3) BENCH_VALUES_10(p##4) \
+    BENCH_VALUES_10(p##5) BENCH_VALUES_10(p##6) BENCH_VALUES_10(p##7) BENCH_VALUES_10(p##8) BENCH_VALUES_10(p##9)
+#define BENCH_VALUES_1000(p) \
+    BENCH_VALUES_100(p##0) BENCH_VALUES_100(p##1) BENCH_VALUES_100(p##2) BENCH_VALUES_100(p##3) BENCH_VALUES_100(p##4) \
+    BENCH_VALUES_100(p##5) BENCH_VALUES_100(p##6) BENCH_VALUES_100(p##7) BENCH_VALUES_100(p##8) BENCH_VALUES_100(p##9)
+
+namespace bench {
+
+//!! Tags=Small,Hot
+struct Small {
+    int32_t id;
+    float value;
+};
+
+//!! Tags=Wide
+struct Wide {
+    BENCH_FIELDS_64(int32_t, f)
+};
+
+//!!
+struct Deep0 {
+    int32_t value;
+};
+
+//!!
+struct Deep1 {
+    Deep0 inner;
+    int32_t value;
+};
+
+//!!
+struct Deep2 {
+    Deep1 inner;
+    int32_t value;
+};
+
+//!!
+struct Deep3 {
+    Deep2 inner;
+    int32_t value;
+};
+
+//!!
+struct Deep4 {
+    Deep3 inner;
+    int32_t value;
+};
+
+//!!
+struct Deep5 {
+    Deep4 inner;
+    int32_t value;
+};
+
+//!!
+struct Deep6 {
+    Deep5 inner;
+    int32_t value;
+};
+
+//!!
+struct Deep7 {
+    Deep6 inner;
+    int32_t value;
+};
+
+//!!
+enum class BigEnum {
+    BENCH_VALUES_1000(Value)
+};
+
+//!! Tags=A,B,C,D,E,F,G,H
+class Overloaded {
+public:
+    int32_t f(int32_t a) { return a + 1; }
+    int64_t f(int64_t a) { return a + 2; }
+    float f(float a) { return a + 3.0f; }
+    double f(double a) { return a + 4.0; }
+    int32_t f(int32_t a, int32_t b) { return a + b; }
+    float f(float a, float b) { return a + b; }
+    double f(double a, double b) { return a + b; }
+    int32_t f(int32_t a, int32_t b, int32_t c) { return a + b + c; }
+
+    int32_t g(int32_t a) { return a * 2; }
+    int32_t h(int32_t a) { return a * 3; }
+};
+
+//!!
+struct Particle {
+    float position[3];
+    float velocity[3];
+    float mass;
+    uint32_t flags;
+};
+
+//!!
+struct Entity {
+    uint32_t id;
+    float x;
+    float y;
+    float z;
+    int32_t health;
+    uint16_t ammo;
+    uint8_t team;
+    bool alive;
+    double last_seen;
+};
+
+//!!
+struct Message {
+    uint32_t id;
+};
+
+//!!
+struct InputMessage : Message {
+    uint32_t device;
+};
+
+//!!
+struct KeyMessage : InputMessage {
+    uint32_t key;
+};
+
+//!!
+struct KeyDownMessage : KeyMessage {
+    bool repeat;
+};
+
+//!!
+struct Timestamped {
+    double time;
+};
+
+//!!
+struct RecordedKeyMessage : KeyDownMessage, Timestamped {
+    uint32_t frame;
+};
+
+//!! Tags=DynamicType
+struct Shape {
+    virtual ~Shape() {}
+    float x;
+    float y;
+};
+
+//!! Tags=DynamicType
+struct Circle : Shape {
+    float radius;
+};
+
+//!!
+struct Samples {
+    std::string name;
+    std::vector<float> values;
+};
+
+//!!
+struct Profile {
+    uint32_t id;
+    std::string name;
+    float score;
+    std::vector<float> history;
+};
+
+}
+
+#undef BENCH_FIELDS_8
+#undef BENCH_FIELDS_64
+#undef BENCH_VALUES_10
+#undef BENCH_VALUES_100
+#undef BENCH_VALUES_1000
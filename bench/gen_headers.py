@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+# Writes a corpus of synthetic annotated headers for benchmarking the generator
+#
+# usage: gen_headers.py <output dir> [--files N] [--records N] [--fields N]
+#                       [--template-params N] [--namespace-depth N] [--enums N] [--enum-values N] [--nested N]
+#                       [--unique-arrays]
+#
+# `--nested` is the number of fields per record that embed the previous record by value. libclang validates
+# the whole embedded type tree every time it computes a field offset, so with more than one the time grows
+# exponentially with the number of records.
+
+import argparse
+import os
+
+FIELD_TYPES = ["int", "float", "double", "unsigned int", "bool", "short", "long long", "char"]
+
+
+def write_header(path, index, args):
+    lines = ["#pragma once", ""]
+
+    namespaces = ["ns{}_{}".format(index, depth) for depth in range(args.namespace_depth)]
+    for namespace in namespaces:
+        lines.append("namespace {} {{".format(namespace))
+
+    if namespaces:
+        lines.append("")
+
+    for e in range(args.enums):
+        lines.append("//!!")
+        lines.append("enum class Enum{}_{} {{".format(index, e))
+        for v in range(args.enum_values):
+            lines.append("    Value{},".format(v))
+        lines.append("};")
+        lines.append("")
+
+    for r in range(args.records):
+        name = "Record{}_{}".format(index, r)
+
+        if args.template_params > 0:
+            params = ", ".join("typename T{}".format(t) for t in range(args.template_params))
+            lines.append("//!!")
+            lines.append("template<{}>".format(params))
+            lines.append("struct Template{}_{} {{".format(index, r))
+            for t in range(args.template_params):
+                lines.append("    T{0} value{0};".format(t))
+            lines.append("};")
+            lines.append("")
+
+        lines.append("//!! Tags=Bench")
+        lines.append("struct {} {{".format(name))
+
+        nested = 0
+        for f in range(args.fields):
+            kind = f % 4
+            field_type = FIELD_TYPES[f % len(FIELD_TYPES)]
+
+            # Mix in pointers, arrays and earlier records so dependent types get generated too
+            if kind == 1 and r > 0:
+                lines.append("    Record{}_{}* ptr{};".format(index, r - 1, f))
+            elif kind == 2:
+                length = (r * args.fields + f + 1) if args.unique_arrays else (f % 7 + 1)
+                lines.append("    {} arr{}[{}];".format(field_type, f, length))
+            elif kind == 3 and r > 0 and nested < args.nested:
+                lines.append("    Record{}_{} nested{};".format(index, r - 1, f))
+                nested += 1
+            else:
+                lines.append("    {} field{};".format(field_type, f))
+
+        lines.append("")
+        lines.append("    int method{}(int a, float b) {{ return a; }}".format(r))
+        lines.append("};")
+        lines.append("")
+
+    for namespace in reversed(namespaces):
+        lines.append("}} // {}".format(namespace))
+
+    with open(path, "w") as file:
+        file.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Writes synthetic annotated headers")
+    parser.add_argument("output")
+    parser.add_argument("--files", type=int, default=10)
+    parser.add_argument("--records", type=int, default=20)
+    parser.add_argument("--fields", type=int, default=8)
+    parser.add_argument("--template-params", type=int, default=0)
+    parser.add_argument("--namespace-depth", type=int, default=1)
+    parser.add_argument("--enums", type=int, default=1)
+    parser.add_argument("--enum-values", type=int, default=16)
+    parser.add_argument("--nested", type=int, default=1)
+    parser.add_argument("--unique-arrays", action="store_true", help="give every array field a different length")
+    args = parser.parse_args()
+
+    os.makedirs(args.output, exist_ok=True)
+
+    for i in range(args.files):
+        write_header(os.path.join(args.output, "synthetic_{}.h".format(i)), i, args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,117 @@
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "type_titan.inc.h"
+#include "type_titan.util.h"
+
+// Stress test for the one-time initialization of type info, every thread races the first `type_of` of the same types.
+// Type info is only built once per process, so run it a few times under `-fsanitize=thread`.
+//
+// usage: thread_init [thread count]
+
+typedef const tt::TypeInfo* (*Getter)();
+
+// Records, the generic specializations, containers and primitives all have their own initialization
+static const Getter GETTERS[] = {
+    []() { return tt::type_of<bench::Small>(); },
+    []() { return tt::type_of<bench::Small*>(); },
+    []() { return tt::type_of<bench::Small[4]>(); },
+    []() { return tt::type_of<bench::Small&>(); },
+    []() { return tt::type_of<bench::Small&&>(); },
+    []() { return tt::type_of<bench::Deep7>(); },
+    []() { return tt::type_of<bench::Deep7*>(); },
+    []() { return tt::type_of<bench::Deep7[4]>(); },
+    []() { return tt::type_of<bench::Wide>(); },
+    []() { return tt::type_of<bench::Entity>(); },
+    []() { return tt::type_of<bench::Entity*[4]>(); },
+    []() { return tt::type_of<bench::RecordedKeyMessage>(); },
+    []() { return tt::type_of<bench::Circle>(); },
+    []() { return tt::type_of<bench::Samples>(); },
+    []() { return tt::type_of<std::vector<float>>(); },
+    []() { return tt::type_of<std::string>(); },
+    []() { return tt::type_of<int32_t>(); },
+    []() { return tt::type_of<float[4]>(); },
+};
+
+static const int GETTER_COUNT = sizeof(GETTERS) / sizeof(GETTERS[0]);
+
+static std::atomic<bool> start(false);
+static std::atomic<int> failures(0);
+
+// Reads the type info the way a user would, so a type that is visible before it's complete shows up as a race
+static void check(const tt::TypeInfo* ti) {
+    if (!ti || ti->type_id == 0 || ti->type_name == nullptr) {
+        failures += 1;
+        return;
+    }
+
+    if (const tt::TypeInfoIndirect* tii = tt::cast<tt::TypeInfoIndirect>(ti)) {
+        if (!tii->underlying || tii->underlying->type_id == 0) failures += 1;
+    } else if (const tt::TypeInfoArray* tia = tt::cast<tt::TypeInfoArray>(ti)) {
+        if (!tia->underlying || tia->length != 4 || tia->size != tia->underlying->size * 4) failures += 1;
+    } else if (const tt::TypeInfoRecord* tir = tt::cast<tt::TypeInfoRecord>(ti)) {
+        for (int i = 0; i < tir->field_count; i++) {
+            if (!tir->fields[i].type_info || !tir->fields[i].name) failures += 1;
+        }
+
+        for (int i = 0; i < tir->parent_count; i++) {
+            if (!tir->parents[i] || tir->parents[i]->type_id == 0) failures += 1;
+        }
+    }
+}
+
+static void worker(int index, const tt::TypeInfo** results) {
+    while (!start.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+
+    // Some threads warm everything up while the others fetch single types
+    if (index % 4 == 3) {
+        tt::warm_up_all();
+    }
+
+    // Every thread starts at a different type so they collide on different ones
+    for (int i = 0; i < GETTER_COUNT; i++) {
+        int getter = (index * 7 + i) % GETTER_COUNT;
+        results[getter] = GETTERS[getter]();
+        check(results[getter]);
+    }
+
+    if (!tt::get_field<bench::Small>("value")) failures += 1;
+}
+
+int main(int argc, char** argv) {
+    int thread_count = (argc > 1) ? atoi(argv[1]) : 64;
+    if (thread_count < 2) thread_count = 2;
+
+    std::vector<const tt::TypeInfo*> results((size_t)thread_count * GETTER_COUNT);
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < thread_count; i++) {
+        threads.emplace_back(worker, i, results.data() + (size_t)i * GETTER_COUNT);
+    }
+
+    start.store(true, std::memory_order_release);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    // Every thread has to see the same type info
+    for (int i = 1; i < thread_count; i++) {
+        for (int j = 0; j < GETTER_COUNT; j++) {
+            if (results[(size_t)i * GETTER_COUNT + j] != results[j]) failures += 1;
+        }
+    }
+
+    if (failures > 0) {
+        fprintf(stderr, "%d failures with %d threads\n", failures.load(), thread_count);
+        return 1;
+    }
+
+    printf("ok, %d threads\n", thread_count);
+    return 0;
+}
@@ -4,47 +4,68 @@
 
 #include "../type_titan/type_titan.util.h"
 
-#define PRINT_PRIMITIVE(type, format) if (ti->type_id == tt::type_of<type>()->type_id) {\
-    printf(format, *((type*)data));\
-    return;\
-}
-
 void json_ser_primitive(const tt::TypeInfo* ti, void* data) {
-    if (ti->type_id == 0) {
-        printf("null");
-        return;
-    }
+    switch (ti->primitive_kind) {
+        case tt::PrimitiveKind::Bool:
+            printf("%s", *((bool*)data) ? "true" : "false");
+            break;
 
-    if (ti->type_id == tt::type_of<wchar_t>()->type_id) {
-        wprintf(L"\"%c\"", *((wchar_t*)data));
-        return;
-    }
+        case tt::PrimitiveKind::I8:
+            printf("%d", *((int8_t*)data));
+            break;
 
-    if (ti->type_id == tt::type_of<char>()->type_id) {
-        wprintf(L"\"%c\"", *((char*)data));
-        return;
-    }
+        case tt::PrimitiveKind::I16:
+            printf("%d", *((int16_t*)data));
+            break;
 
-    if (ti->type_id == tt::type_of<bool>()->type_id) {
-        printf("%s", *((bool*)data) ? "true" : "false");
-        return;
-    }
+        case tt::PrimitiveKind::I32:
+            printf("%ld", (long)*((int32_t*)data));
+            break;
 
-    PRINT_PRIMITIVE(int8_t, "%d");
-    PRINT_PRIMITIVE(int16_t, "%d");
-    PRINT_PRIMITIVE(int32_t, "%ld");
-    PRINT_PRIMITIVE(int64_t, "%lld");
+        case tt::PrimitiveKind::I64:
+            printf("%lld", (long long)*((int64_t*)data));
+            break;
 
-    PRINT_PRIMITIVE(uint8_t, "%d");
-    PRINT_PRIMITIVE(uint16_t, "%u");
-    PRINT_PRIMITIVE(uint32_t, "%lu");
-    PRINT_PRIMITIVE(uint64_t, "%llu");
+        case tt::PrimitiveKind::U8:
+            printf("%d", *((uint8_t*)data));
+            break;
 
-    PRINT_PRIMITIVE(float, "%f");
-    PRINT_PRIMITIVE(double, "%f");
-}
+        case tt::PrimitiveKind::U16:
+            printf("%u", *((uint16_t*)data));
+            break;
+
+        case tt::PrimitiveKind::U32:
+            printf("%lu", (unsigned long)*((uint32_t*)data));
+            break;
+
+        case tt::PrimitiveKind::U64:
+            printf("%llu", (unsigned long long)*((uint64_t*)data));
+            break;
+
+        case tt::PrimitiveKind::F32:
+            printf("%f", *((float*)data));
+            break;
+
+        case tt::PrimitiveKind::F64:
+            printf("%f", *((double*)data));
+            break;
 
-#undef PRINT_PRIMITIVE
+        case tt::PrimitiveKind::Char:
+            wprintf(L"\"%c\"", *((char*)data));
+            break;
+
+        case tt::PrimitiveKind::WChar:
+            wprintf(L"\"%c\"", *((wchar_t*)data));
+            break;
+
+        case tt::PrimitiveKind::None:
+            printf("null");
+            break;
+
+        default:
+            break;
+    }
+}
 
 
 void json_ser_array(const tt::TypeInfo* ti, void* data, int indentation) {
@@ -73,21 +94,69 @@ void json_ser_array(const tt::TypeInfo* ti, void* data, int indentation) {
     printf("]");
 }
 
+void json_ser_container(const tt::TypeInfo* ti, void* data, int indentation) {
+    const tt::TypeInfoContainer* tic = tt::cast<tt::TypeInfoContainer>(ti);
+
+    if (!tic) return;
+
+    size_t size = tic->get_size(data);
+    uint8_t* elements = tic->get_data ? (uint8_t*)tic->get_data(data) : nullptr;
+
+    if (tic->container_type == tt::ContainerType::String && tic->underlying->primitive_kind == tt::PrimitiveKind::Char) {
+        printf("\"%.*s\"", (int)size, (const char*)elements);
+        return;
+    }
+
+    if (tic->container_type == tt::ContainerType::Optional) {
+        if (elements) {
+            json_serialize_internal(tic->underlying, elements, indentation - 1);
+        } else {
+            printf("null");
+        }
+
+        return;
+    }
+
+    // `std::vector<bool>` has no pointer to its elements
+    if (!elements && size > 0) {
+        printf("null");
+        return;
+    }
+
+    printf("[\n");
+
+    for (size_t i = 0; i < size; i++) {
+        for (int indent = 0; indent < indentation; indent++) {
+            printf("    ");
+        }
+        json_serialize_internal(tic->underlying, elements + (uint64_t)tic->underlying->size * i, indentation);
+
+        if (i + 1 < size) {
+            printf(",");
+        }
+
+        printf("\n");
+    }
+
+    for (int indent = 0; indent < indentation - 1; indent++) {
+        printf("    ");
+    }
+    printf("]");
+}
+
 void json_ser_indirect(const tt::TypeInfo* ti, void* data) {
     const tt::TypeInfoIndirect* tii = tt::cast<tt::TypeInfoIndirect>(ti);
 
     if (!tii) return;
 
-    int id = tt::get_underlying(ti)->type_id;
+    tt::PrimitiveKind kind = tt::get_underlying(ti)->primitive_kind;
 
-    if (id == tt::type_of<char*>()->type_id ||
-        id == tt::type_of<const char*>()->type_id) {
+    if (tii->indirect_type == tt::IndirectType::Pointer && kind == tt::PrimitiveKind::Char) {
         printf("\"%s\"", *((char**)data));
         return;
     }
 
-    if (id == tt::type_of<wchar_t*>()->type_id ||
-        id == tt::type_of<const wchar_t*>()->type_id) {
+    if (tii->indirect_type == tt::IndirectType::Pointer && kind == tt::PrimitiveKind::WChar) {
         wprintf(L"\"%s\"", *((wchar_t**)data));
         return;
     }
@@ -182,5 +251,9 @@ void json_serialize_internal(const tt::TypeInfo* ti, void* data, int indentation
         case tt::TypeInfoType::Enum:
             json_ser_enum(ti, data);
             break;
+
+        case tt::TypeInfoType::Container:
+            json_ser_container(ti, data, indentation + 1);
+            break;
     }
 }
@@ -8,47 +8,68 @@
 
 void print_internal(const tt::TypeInfo* ti, void* data, int indentation);
 
-#define PRINT_PRIMITIVE(type, format) if (ti->type_id == tt::type_of<type>()->type_id) {\
-    printf(format, *((type*)data));\
-    return;\
-}
-
 void print_primitive(const tt::TypeInfo* ti, void* data) {
-    if (ti->type_id == 0) {
-        printf("(unindexed)");
-        return;
-    }
+    switch (ti->primitive_kind) {
+        case tt::PrimitiveKind::Bool:
+            printf("%s", *((bool*)data) ? "true" : "false");
+            break;
 
-    if (ti->type_id == tt::type_of<wchar_t>()->type_id) {
-        wprintf(L"%c", *((wchar_t*)data));
-        return;
-    }
+        case tt::PrimitiveKind::I8:
+            printf("%d", *((int8_t*)data));
+            break;
 
-    if (ti->type_id == tt::type_of<char>()->type_id) {
-        wprintf(L"%c", *((char*)data));
-        return;
-    }
+        case tt::PrimitiveKind::I16:
+            printf("%d", *((int16_t*)data));
+            break;
 
-    if (ti->type_id == tt::type_of<bool>()->type_id) {
-        printf("%s", *((bool*)data) ? "true" : "false");
-        return;
-    }
+        case tt::PrimitiveKind::I32:
+            printf("%ld", (long)*((int32_t*)data));
+            break;
 
-    PRINT_PRIMITIVE(int8_t, "%d");
-    PRINT_PRIMITIVE(int16_t, "%d");
-    PRINT_PRIMITIVE(int32_t, "%ld");
-    PRINT_PRIMITIVE(int64_t, "%lld");
+        case tt::PrimitiveKind::I64:
+            printf("%lld", (long long)*((int64_t*)data));
+            break;
 
-    PRINT_PRIMITIVE(uint8_t, "%d");
-    PRINT_PRIMITIVE(uint16_t, "%u");
-    PRINT_PRIMITIVE(uint32_t, "%lu");
-    PRINT_PRIMITIVE(uint64_t, "%llu");
+        case tt::PrimitiveKind::U8:
+            printf("%d", *((uint8_t*)data));
+            break;
 
-    PRINT_PRIMITIVE(float, "%f");
-    PRINT_PRIMITIVE(double, "%f");
-}
+        case tt::PrimitiveKind::U16:
+            printf("%u", *((uint16_t*)data));
+            break;
 
-#undef PRINT_PRIMITIVE
+        case tt::PrimitiveKind::U32:
+            printf("%lu", (unsigned long)*((uint32_t*)data));
+            break;
+
+        case tt::PrimitiveKind::U64:
+            printf("%llu", (unsigned long long)*((uint64_t*)data));
+            break;
+
+        case tt::PrimitiveKind::F32:
+            printf("%f", *((float*)data));
+            break;
+
+        case tt::PrimitiveKind::F64:
+            printf("%f", *((double*)data));
+            break;
+
+        case tt::PrimitiveKind::Char:
+            wprintf(L"%c", *((char*)data));
+            break;
+
+        case tt::PrimitiveKind::WChar:
+            wprintf(L"%c", *((wchar_t*)data));
+            break;
+
+        case tt::PrimitiveKind::None:
+            printf("(unindexed)");
+            break;
+
+        default:
+            break;
+    }
+}
 
 void print_array(const tt::TypeInfo* ti, void* data, int indentation = 0) {
     const tt::TypeInfoArray* tia = tt::cast<tt::TypeInfoArray>(ti);
@@ -71,18 +92,55 @@ void print_array(const tt::TypeInfo* ti, void* data, int indentation = 0) {
     printf("]");
 }
 
+void print_container(const tt::TypeInfo* ti, void* data, int indentation = 0) {
+    const tt::TypeInfoContainer* tic = tt::cast<tt::TypeInfoContainer>(ti);
+
+    if (!tic) return;
+
+    size_t size = tic->get_size(data);
+    uint8_t* elements = tic->get_data ? (uint8_t*)tic->get_data(data) : nullptr;
+
+    if (tic->container_type == tt::ContainerType::String && tic->underlying->primitive_kind == tt::PrimitiveKind::Char) {
+        printf("\"%.*s\"", (int)size, (const char*)elements);
+        return;
+    }
+
+    if (tic->container_type == tt::ContainerType::Optional) {
+        if (elements) {
+            print_internal(tic->underlying, elements, indentation - 1);
+        } else {
+            printf("(empty)");
+        }
+
+        return;
+    }
+
+    printf("[\n");
+    for (size_t i = 0; i < size && elements; i++) {
+        for (int indent = 0; indent < indentation; indent++) {
+            printf("    ");
+        }
+        print_internal(tic->underlying, elements + (uint64_t)tic->underlying->size * i, indentation);
+        printf("\n");
+    }
+
+    for (int indent = 0; indent < indentation - 1; indent++) {
+        printf("    ");
+    }
+
+    printf("]");
+}
+
 void print_indirect(const tt::TypeInfo* ti, void* data) {
     const tt::TypeInfoIndirect* tii = tt::cast<tt::TypeInfoIndirect>(ti);
 
     if (!tii) return;
 
     if (tii->indirect_type == tt::IndirectType::Pointer) {
-        if (tii->type_id == tt::type_of<wchar_t*>()->type_id ||
-            tii->type_id == tt::type_of<const wchar_t*>()->type_id) {
+        if (tii->underlying->primitive_kind == tt::PrimitiveKind::WChar) {
             wprintf(L"\"%s\"", *((wchar_t**)data));
             return;
-        } else if (tii->type_id == tt::type_of<char*>()->type_id ||
-            tii->type_id == tt::type_of<const char*>()->type_id) {
+        } else if (tii->underlying->primitive_kind == tt::PrimitiveKind::Char) {
             printf("\"%s\"", *((char**)data));
             return;
         }
@@ -99,13 +157,7 @@ void print_function(const tt::TypeInfo* ti) {
     printf("%s %s(\n", tif->return_type->type_name, tif->type_name);
 
     for (auto& param : tt::get_parameters(ti)) {
-        printf("    %s %s", param.type_info->type_name, param.name);
-
-        if (param.has_value) {
-            printf(" [has value]");
-        }
-
-        printf("\n");
+        printf("    %s %s\n", param.type_info->type_name, param.name);
     }
 }
 
@@ -114,14 +166,15 @@ void print_record(const tt::TypeInfo* ti, void* data, int indentation, bool use_
         printf("{\n");
     }
 
-    // We only print the first parent because we know it starts at offset 0
-    int parent_count = 0;
+    int parent_index = 0;
     for (auto& parent : tt::get_parents(ti)) {
-        if (parent_count == 0) {
-            print_record(parent, data, indentation, false);
+        uint32_t offset = tt::get_parent_offsets(ti)[parent_index];
+
+        if (offset != tt::UNKNOWN_OFFSET) {
+            print_record(parent, ((uint8_t*)data) + offset, indentation, false);
         }
 
-        parent_count += 1;
+        parent_index += 1;
     }
 
     const tt::TypeInfoRecord* tir = tt::cast<tt::TypeInfoRecord>(ti);
@@ -160,9 +213,9 @@ void print_record(const tt::TypeInfo* ti, void* data, int indentation, bool use_
 
 void print_enum(const tt::TypeInfo* ti, int value) {
     int i = 0;
-    for (auto& enum_value : tt::get_enumerator_values(ti)) {
+    for (auto& enum_value : tt::get_enum_values(ti)) {
         if (value == enum_value) {
-            printf("%s::%s", ti->type_name, tt::get_enumerators(ti)[i]);
+            printf("%s::%s", ti->type_name, tt::get_enum_names(ti)[i]);
             return;
         }
 
@@ -204,5 +257,9 @@ void print_internal(const tt::TypeInfo* ti, void* data, int indentation) {
         case tt::TypeInfoType::Enum:
             print_enum(ti, *(int*)(data));
             break;
+
+        case tt::TypeInfoType::Container:
+            print_container(ti, data, indentation + 1);
+            break;
     }
 }
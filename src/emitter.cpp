@@ -6,6 +6,7 @@
 #include <unordered_map>
 #include <algorithm>
 #include <memory>
+#include <cstring>
 
 #include "helper.h"
 #include "source_code.h"
@@ -27,11 +28,103 @@ struct Primitive {
 // val: primitive type handle
 static std::map<std::string, Primitive> primitives_to_emit;
 
+// All the dependent primitives that have already been emitted, so they don't get emitted twice
+// key: qualified name
+static std::set<std::string> emitted_primitives;
+
+// The dependent primitives that were added since the last call to `emit_dependent_types`,
+// so it doesn't have to go over all of `primitives_to_emit` every time
+// val: qualified name
+static std::vector<std::string> pending_dependent_types;
+
+struct EmittedField {
+    std::string name;
+    std::string type_name;           // As passed to `type_of<>`
+    std::string canonical_type_name; // Used if `type_name` was spelled differently than the emitted type
+    std::string size;                // A `sizeof` expression
+    long long offset;
+    int bit_width;
+    int bit_shift;
+    std::string access;
+    std::vector<std::string> tags;
+};
+
+struct EmittedParent {
+    std::string type_name;
+    std::string offset; // A `base_offset` expression or `UNKNOWN_OFFSET`
+};
+
+struct EmittedType {
+    std::string qualified_name;
+    std::string size = "0"; // A `sizeof` expression, "0" if the type has no size
+    std::vector<EmittedField> fields;
+    std::vector<std::string> tags;
+
+    // Only used for the type table
+    std::string type_kind;
+    std::string type_name;
+    size_t type_id = 0;
+    std::string subtype = "0";  // A RecordType or IndirectType
+    std::string underlying;     // The qualified name of the underlying type
+    long long length = 0;
+    std::vector<EmittedParent> parents;
+    std::vector<std::pair<std::string, long long>> enums;
+};
+
+// All the non-template types that have been emitted, in the order they were emitted
+// The index in this list is the type index
+static std::vector<EmittedType> emitted_types;
+
 // All the free functions that have been emitted
 // key: qualified name/signature
 // val: the function name
 static std::unordered_map<std::string, std::string> emitted_functions;
 
+struct TypeHash {
+    size_t operator()(const CXType& type) const {
+        return std::hash<void*>{}(type.data[0]) ^ (std::hash<void*>{}(type.data[1]) << 1) ^ (size_t)type.kind;
+    }
+};
+
+struct TypeEqual {
+    bool operator()(const CXType& a, const CXType& b) const {
+        return a.kind == b.kind && clang_equalTypes(a, b);
+    }
+};
+
+struct CursorHash {
+    size_t operator()(const CXCursor& cursor) const {
+        return clang_hashCursor(cursor);
+    }
+};
+
+struct CursorEqual {
+    bool operator()(const CXCursor& a, const CXCursor& b) const {
+        return clang_equalCursors(a, b);
+    }
+};
+
+// The same types get looked up for every field, method, parameter and primitive, so the results are cached.
+// Types and cursors are only valid within their translation unit, so the caches are cleared for every unit
+static struct TypeCache {
+    std::unordered_map<CXType, std::string, TypeHash, TypeEqual> spellings;
+    std::unordered_map<CXType, CXType, TypeHash, TypeEqual> canonical_types;
+    std::unordered_map<CXType, CXCursor, TypeHash, TypeEqual> declarations;
+    std::unordered_map<CXCursor, std::string, CursorHash, CursorEqual> namespaces;
+
+    CacheStats spelling_stats = { "spelling", 0, 0 };
+    CacheStats canonical_stats = { "canonical", 0, 0 };
+    CacheStats declaration_stats = { "declaration", 0, 0 };
+    CacheStats namespace_stats = { "namespace", 0, 0 };
+
+    void clear() {
+        spellings.clear();
+        canonical_types.clear();
+        declarations.clear();
+        namespaces.clear();
+    }
+} type_cache;
+
 // If `type` is a primitive type, add it to all types that are going to be emitted
 bool add_primitive_type(CXType type);
 
@@ -42,14 +135,18 @@ void emit_common_start(std::ostream& output, std::string type_kind, std::string
 // Ends the `info()` function, does not end the `Type<>` class
 void emit_common_end(std::ostream& output);
 
-// Emits tags for whatever the current cursor is
-void emit_tags(std::ostream& output, CXCursor cursor, std::vector<std::string>& args,
-               std::string lhs = "type", std::string array_name = "tags");
+// Emits tags for whatever the current cursor is and returns them
+std::vector<std::string> emit_tags(std::ostream& output, CXCursor cursor, std::vector<std::string>& args,
+                                   std::string lhs = "type", std::string array_name = "tags");
 
 // Emits the parameters for the function
 void emit_parameters(std::ostream& output, CXCursor type, std::string lhs = "type", std::string array_name = "parameters");
 
-// Adds nested types for ConstantArrays, Pointers and L/R references
+// Emits the getter/setter thunks of a field, or nullptr if the field can't be accessed directly
+void emit_field_accessors(std::ostream& output, CXCursor field, CXType field_type, std::string lhs,
+                          std::string qualified_name);
+
+// Adds nested types for ConstantArrays, Pointers, L/R references and template arguments
 void add_nested_types(CXType type);
 
 // Adds all nested types, e.g.
@@ -65,10 +162,17 @@ void create_primitive(CXType type, Primitive& p);
 // int*** -> int
 CXType get_deepest_type(CXType type);
 
-std::string get_namespace(CXCursor decl);
+// Cached versions of `clang_getTypeSpelling`, `clang_getCanonicalType` and `clang_getTypeDeclaration`
+const std::string& get_type_spelling(CXType type);
+CXType get_canonical_type(CXType type);
+CXCursor get_type_declaration(CXType type);
+
+const std::string& get_namespace(CXCursor decl);
 
 // Emitting the specific types
 void emit_cursor(std::ostream& output, CXCursor cursor, std::vector<std::string>& args);
+// Emits the alignment, trait flags and lifecycle thunks, records marked `NoCopy` don't get a copy thunk
+void emit_lifecycle(std::ostream& output, const std::string& qualified_name, const std::vector<std::string>& args);
 void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std::string>& args,
                          std::string qualified_name, std::string template_args);
 void emit_template_record(std::ostream& output, CXCursor cursor, std::vector<std::string>& args);
@@ -82,35 +186,137 @@ int emit_dependent_types(std::ostream& output);
 // Implementations
 //
 
-int emit_eligable_children(std::ostream& output, CXCursor cursor) {
-    struct ChildData {
-        int emitted = 0;
-        std::ostream& output;
-    } cd = { 0, output };
+// Calls `func(cursor, args)` for every annotated declaration in the main file, stops if it returns false
+template<typename F>
+static void visit_annotated_children(CXCursor cursor, F func) {
+    // Index the annotations of the main file so we only have to get the comments of declarations
+    // that could be annotated, without the contents every cursor is checked
+    CXTranslationUnit unit = clang_Cursor_getTranslationUnit(cursor);
+    ClangStr unit_name = clang_getTranslationUnitSpelling(unit);
+    CXFile main_file = clang_getFile(unit, unit_name.c_str());
+
+    size_t length = 0;
+    const char* contents = main_file ? clang_getFileContents(unit, main_file, &length) : nullptr;
+
+    std::unique_ptr<AnnotationIndex> index;
+    if (contents) {
+        index.reset(new AnnotationIndex(contents, length));
+    }
+
+    struct VisitData {
+        const AnnotationIndex* index;
+        F* func;
+    } vd = { index.get(), &func };
 
     clang_visitChildren(cursor, [](CXCursor c, CXCursor parent, CXClientData data) {
-        ChildData* cd = (ChildData*)data;
+        VisitData* vd = (VisitData*)data;
 
         // Only parse things from the main file
         if (!clang_Location_isFromMainFile(clang_getCursorLocation(c))) {
             return CXChildVisit_Continue;
         }
 
-        std::vector<std::string> args;
-        if (get_args(c, args)) {
-            std::ostringstream tmp;
+        if (vd->index) {
+            CXSourceRange extent = clang_getCursorExtent(c);
+            unsigned start = 0;
+            unsigned end = 0;
+
+            clang_getFileLocation(clang_getRangeStart(extent), nullptr, nullptr, nullptr, &start);
+            clang_getFileLocation(clang_getRangeEnd(extent), nullptr, nullptr, nullptr, &end);
 
-            cd->emitted += 1;
-            emit_cursor(tmp, c, args);
-            cd->emitted += emit_dependent_types(cd->output);
-            cd->output << tmp.str();
+            if (!vd->index->is_candidate(start)) {
+                // Nothing in here is annotated, so there's no need to look at the children either
+                return vd->index->has_annotations_in(start, end) ? CXChildVisit_Recurse : CXChildVisit_Continue;
+            }
+        }
+
+        std::vector<std::string> args;
+        if (get_args(c, args) && !(*vd->func)(c, args)) {
+            return CXChildVisit_Break;
         }
 
         return CXChildVisit_Recurse;
-    }, &cd);
+    }, &vd);
+}
+
+int emit_eligable_children(std::ostream& output, CXCursor cursor) {
+    type_cache.clear();
+
+    int emitted = 0;
+
+    visit_annotated_children(cursor, [&](CXCursor c, std::vector<std::string>& args) {
+        std::ostringstream tmp;
+
+        emitted += 1;
+        emit_cursor(tmp, c, args);
+        emitted += emit_dependent_types(output);
+        output << tmp.str();
+
+        return true;
+    });
+
+    emitted += emit_dependent_types(output);
+    return emitted;
+}
+
+bool validate_annotated_children(CXCursor cursor) {
+    CXTranslationUnit unit = clang_Cursor_getTranslationUnit(cursor);
+
+    // Every error in the main file, types that couldn't be resolved always produce one
+    std::vector<unsigned> errors;
+
+    for (unsigned i = 0; i < clang_getNumDiagnostics(unit); i++) {
+        CXDiagnostic diag = clang_getDiagnostic(unit, i);
+        CXDiagnosticSeverity severity = clang_getDiagnosticSeverity(diag);
 
-    cd.emitted += emit_dependent_types(output);
-    return cd.emitted;
+        if (severity == CXDiagnostic_Error || severity == CXDiagnostic_Fatal) {
+            CXSourceLocation location = clang_getDiagnosticLocation(diag);
+
+            if (clang_Location_isFromMainFile(location)) {
+                unsigned offset = 0;
+                clang_getFileLocation(location, nullptr, nullptr, nullptr, &offset);
+                errors.push_back(offset);
+            }
+        }
+
+        clang_disposeDiagnostic(diag);
+    }
+
+    bool valid = true;
+
+    visit_annotated_children(cursor, [&](CXCursor c, std::vector<std::string>&) {
+        if (clang_isInvalidDeclaration(c)) {
+            valid = false;
+            return false;
+        }
+
+        CXSourceRange extent = clang_getCursorExtent(c);
+        unsigned start = 0;
+        unsigned end = 0;
+
+        clang_getFileLocation(clang_getRangeStart(extent), nullptr, nullptr, nullptr, &start);
+        clang_getFileLocation(clang_getRangeEnd(extent), nullptr, nullptr, nullptr, &end);
+
+        for (unsigned offset : errors) {
+            if (offset >= start && offset <= end) {
+                valid = false;
+                return false;
+            }
+        }
+
+        // A record can be fine by itself but embed a type that's broken somewhere else in the file
+        CXCursorKind kind = clang_getCursorKind(c);
+        if (kind == CXCursor_StructDecl || kind == CXCursor_ClassDecl || kind == CXCursor_UnionDecl) {
+            if (clang_Type_getSizeOf(clang_getCursorType(c)) < 0) {
+                valid = false;
+                return false;
+            }
+        }
+
+        return true;
+    });
+
+    return valid;
 }
 
 void emit_cursor(std::ostream& output, CXCursor cursor, std::vector<std::string>& args) {
@@ -149,7 +355,7 @@ void emit_cursor(std::ostream& output, CXCursor cursor, std::vector<std::string>
     switch (clang_getCursorKind(cursor)) {
         case CXCursor_TypedefDecl: {
             CXType underlying = clang_getTypedefDeclUnderlyingType(cursor);
-            add_primitive_type(clang_getCanonicalType(underlying));
+            add_primitive_type(get_canonical_type(underlying));
             break;
         }
 
@@ -173,13 +379,191 @@ void emit_cursor(std::ostream& output, CXCursor cursor, std::vector<std::string>
     }
 }
 
-void add_common_primitives(const std::vector<std::string>& clang_args) {
-    CXTranslationUnit unit = parse_translation_unit(common_primitives_h, "primitives.h", clang_args);
+// A primitive without its clang type, so it can be added without parsing anything
+struct BuiltinPrimitive {
+    CXTypeKind kind;
+    const char* name;
+    const char* underlying; // Empty if it has none
+    CXTypeKind deepest;     // CXType_Invalid if it has none
+};
+
+#if defined(_WIN32) || defined(__APPLE__) || !(defined(__LP64__) || defined(_LP64))
+#define TT_INT64_KIND CXType_LongLong
+#define TT_INT64_NAME "long long"
+#define TT_UINT64_KIND CXType_ULongLong
+#define TT_UINT64_NAME "unsigned long long"
+#else
+#define TT_INT64_KIND CXType_Long
+#define TT_INT64_NAME "long"
+#define TT_UINT64_KIND CXType_ULong
+#define TT_UINT64_NAME "unsigned long"
+#endif
+
+// What parsing `common_primitives_h` results in when clang targets the same platform TypeTitan was built for,
+// the 64-bit integers are the only ones that are spelled differently between platforms
+static const BuiltinPrimitive BUILTIN_PRIMITIVES[] = {
+    { CXType_Bool, "bool", "", CXType_Invalid },
+    { CXType_SChar, "signed char", "", CXType_Invalid },
+    { CXType_Short, "short", "", CXType_Invalid },
+    { CXType_Int, "int", "", CXType_Invalid },
+    { TT_INT64_KIND, TT_INT64_NAME, "", CXType_Invalid },
+    { CXType_UChar, "unsigned char", "", CXType_Invalid },
+    { CXType_UShort, "unsigned short", "", CXType_Invalid },
+    { CXType_UInt, "unsigned int", "", CXType_Invalid },
+    { TT_UINT64_KIND, TT_UINT64_NAME, "", CXType_Invalid },
+    { CXType_Float, "float", "", CXType_Invalid },
+    { CXType_Double, "double", "", CXType_Invalid },
+    { CXType_WChar, "wchar_t", "", CXType_Invalid },
+    { CXType_Void, "void", "", CXType_Invalid },
+    { CXType_Pointer, "void *", "void", CXType_Void }
+};
+
+#undef TT_INT64_KIND
+#undef TT_INT64_NAME
+#undef TT_UINT64_KIND
+#undef TT_UINT64_NAME
+
+static const char* PRIMITIVE_CACHE_HEADER = "TypeTitan primitive cache 1";
+
+static void add_builtin_primitive(CXTypeKind kind, const std::string& name, const std::string& underlying,
+                                  long long array_length, CXTypeKind deepest) {
+    Primitive p;
+    p.kind = kind;
+    p.qualified_type_name = name;
+    p.type_name = name;
+    p.underlying_name = underlying;
+    p.array_length = array_length;
+
+    if (p.type_name.find(':') != std::string::npos) {
+        p.type_name.erase(0, p.type_name.rfind(':') + 1);
+    }
+
+    if (deepest != CXType_Invalid) {
+        p.deepest = std::make_shared<Primitive>();
+        p.deepest->kind = deepest;
+    }
+
+    primitives_to_emit[name] = p;
+}
+
+// Returns true if none of the arguments can change the target or what <cstdint> resolves to,
+// in which case the primitives are known without parsing anything
+static bool uses_default_target(const std::vector<std::string>& clang_args) {
+    static const char* SAFE_PREFIXES[] = {
+        "-std=c++", "-std=gnu++", "-xc++", "-I", "-isystem", "-D", "-U", "-W", "-w", "-f", "-O", "-g"
+    };
+
+    for (size_t i = 0; i < clang_args.size(); i++) {
+        const std::string& arg = clang_args[i];
+        bool safe = false;
+
+        for (const char* prefix : SAFE_PREFIXES) {
+            if (arg.compare(0, strlen(prefix), prefix) == 0) {
+                safe = true;
+                break;
+            }
+        }
+
+        // The value of `-I dir`, `-isystem dir` and `-D name`
+        if (!safe && i > 0 && arg.front() != '-' &&
+            (clang_args[i - 1] == "-I" || clang_args[i - 1] == "-isystem" ||
+             clang_args[i - 1] == "-D" || clang_args[i - 1] == "-U")) {
+            safe = true;
+        }
+
+        if (!safe) return false;
+    }
+
+    return true;
+}
+
+// The primitives depend on the arguments and the version of clang
+static std::string get_primitive_cache_key(const std::vector<std::string>& clang_args) {
+    std::string key = ClangStr(clang_getClangVersion()).c_str();
+
+    for (auto& arg : clang_args) {
+        key += '\t' + arg;
+    }
+
+    return key;
+}
+
+static bool load_primitive_cache(const std::string& path, const std::string& key) {
+    std::ifstream in(path);
+    if (!in.is_open()) return false;
+
+    std::string line;
+    if (!std::getline(in, line) || line != PRIMITIVE_CACHE_HEADER) return false;
+    if (!std::getline(in, line) || line != "K\t" + key) return false;
+
+    std::vector<std::string> parts;
+
+    while (std::getline(in, line)) {
+        // P <kind> <array length> <deepest kind> <name> <underlying>
+        std::stringstream ss(line);
+        std::string part;
+
+        parts.clear();
+        while (std::getline(ss, part, '\t')) {
+            parts.push_back(part);
+        }
+
+        if (parts.size() < 5 || parts[0] != "P") return false;
+
+        add_builtin_primitive((CXTypeKind)strtol(parts[1].c_str(), nullptr, 10), parts[4], (parts.size() > 5) ? parts[5] : "",
+                              strtoll(parts[2].c_str(), nullptr, 10), (CXTypeKind)strtol(parts[3].c_str(), nullptr, 10));
+    }
+
+    return true;
+}
+
+static void save_primitive_cache(const std::string& path, const std::string& key) {
+    std::ofstream out(path);
+    if (!out.is_open()) return;
+
+    out << PRIMITIVE_CACHE_HEADER << "\nK\t" << key << "\n";
+
+    for (auto& entry : primitives_to_emit) {
+        const Primitive& p = entry.second;
+        long long array_length = (p.kind == CXType_ConstantArray) ? p.array_length : 0;
+
+        out <<
+            "P\t" << (int)p.kind << "\t" << array_length << "\t" << (int)(p.deepest ? p.deepest->kind : CXType_Invalid) <<
+            "\t" << entry.first << "\t" << p.underlying_name << "\n";
+    }
+}
+
+PrimitiveSource add_common_primitives(const std::vector<std::string>& clang_args, const std::string& cache_path) {
+    if (uses_default_target(clang_args)) {
+        for (const BuiltinPrimitive& builtin : BUILTIN_PRIMITIVES) {
+            add_builtin_primitive(builtin.kind, builtin.name, builtin.underlying, 0, builtin.deepest);
+        }
+
+        return PrimitiveSource::Table;
+    }
+
+    std::string key = get_primitive_cache_key(clang_args);
+
+    if (!cache_path.empty()) {
+        if (load_primitive_cache(cache_path, key)) {
+            return PrimitiveSource::Cache;
+        }
+
+        primitives_to_emit.clear();
+    }
+
+    CXTranslationUnit unit = parse_translation_unit(common_primitives_h, strlen(common_primitives_h), "primitives.h", clang_args);
 
-    if (!unit) return;
+    if (!unit) return PrimitiveSource::Parse;
 
     std::ostringstream dummy;
     emit_eligable_children(dummy, clang_getTranslationUnitCursor(unit));
+
+    if (!cache_path.empty()) {
+        save_primitive_cache(cache_path, key);
+    }
+
+    return PrimitiveSource::Parse;
 }
 
 void emit_common_file_start(std::ostream& output, const char* type_titan_inc, const char* orig_file_name,
@@ -191,7 +575,19 @@ void emit_common_file_start(std::ostream& output, const char* type_titan_inc, co
     if (is_core_file) {
         output <<
             "#include <stdint.h>\n"
-            "#include <string.h>\n";
+            "#include <string.h>\n"
+            "#include <atomic>\n"
+            "#include <mutex>\n"
+            "#include <new>\n"
+            "#include <type_traits>\n"
+            "#include <vector>\n"
+            "#include <string>\n"
+            "#include <array>\n\n"
+
+            "#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)\n"
+            "#include <optional>\n"
+            "#define TT_HAS_OPTIONAL\n"
+            "#endif\n";
     } else {
         output <<
             "#include " << type_titan_inc << "\n"
@@ -206,6 +602,518 @@ void emit_all_primitives(std::ostream& output) {
     }
 }
 
+void emit_warm_up(std::ostream& output) {
+    output << "static const type_info_getter_t ALL_TYPES[] = {\n";
+
+    for (auto& type : emitted_types) {
+        output << "    &Type<" << type.qualified_name << ">::info,\n";
+    }
+
+    // Zero-length arrays aren't allowed
+    if (emitted_types.empty()) {
+        output << "    nullptr\n";
+    }
+
+    output <<
+        "};\n\n"
+        "static const int ALL_TYPES_COUNT = " << emitted_types.size() << ";\n\n"
+        "// Builds the type info of every indexed type, in the order they were generated\n"
+        "static WarmUpStats warm_up_all() {\n"
+        "    return warm_up(ALL_TYPES, ALL_TYPES_COUNT);\n"
+        "}\n\n"
+        "#if defined(TT_WARM_UP_ON_STARTUP)\n"
+        "extern const WarmUpStats startup_warm_up;\n\n"
+        "// Only defined in the translation unit that defines `TYPE_TITAN_IMPL`, so it runs once per program\n"
+        "#if defined(TYPE_TITAN_IMPL)\n"
+        "extern const WarmUpStats startup_warm_up = warm_up_all();\n"
+        "#endif\n"
+        "#endif\n";
+}
+
+// Looks up the type index of `name`, or `fallback_name` if `name` was spelled differently than the emitted type
+static std::string find_type_index(const std::unordered_map<std::string, size_t>& type_indices,
+                                   const std::string& name, const std::string& fallback_name = "") {
+    auto it = type_indices.find(name);
+
+    if (it == type_indices.end()) {
+        it = type_indices.find(fallback_name);
+    }
+
+    return (it != type_indices.end()) ? std::to_string(it->second) : std::string("INVALID_TYPE_INDEX");
+}
+
+static std::unordered_map<std::string, size_t> get_type_indices() {
+    std::unordered_map<std::string, size_t> type_indices;
+    for (size_t i = 0; i < emitted_types.size(); i++) {
+        type_indices.insert({ emitted_types[i].qualified_name, i });
+    }
+
+    return type_indices;
+}
+
+// A field that isn't a record itself, with its offset in the outermost record
+struct LeafField {
+    std::string offset;     // A number, or a sum with `base_offset` expressions for inherited fields
+    size_t field;           // The index in `COMPACT_FIELDS_COLD`
+    std::string type_index;
+    std::string size;
+};
+
+struct LeafData {
+    std::unordered_map<std::string, size_t> type_indices;
+    std::vector<size_t> first_fields;
+    std::vector<std::vector<LeafField>> leaves;
+    std::vector<bool> collected;
+};
+
+static std::string offset_leaf(const std::string& base, const std::string& offset) {
+    if (base == "0") return offset;
+    if (offset == "0") return base;
+
+    return base + " + " + offset;
+}
+
+static size_t find_record_index(const LeafData& data, const EmittedField& field) {
+    auto it = data.type_indices.find(field.type_name);
+    if (it == data.type_indices.end()) {
+        it = data.type_indices.find(field.canonical_type_name);
+    }
+
+    if (it == data.type_indices.end()) return SIZE_MAX;
+
+    // Unions overlap, so their members can't be flattened
+    const EmittedType& type = emitted_types[it->second];
+    if (type.type_kind != "Record" || type.subtype == "(uint8_t)RecordType::Union") return SIZE_MAX;
+
+    return it->second;
+}
+
+// Flattens the fields of parents and by-value records into `data.leaves[index]`.
+// Parents with an unknown offset (e.g. virtual bases) and parents that aren't indexed are left out
+static void collect_leaves(size_t index, LeafData& data) {
+    if (data.collected[index]) return;
+    data.collected[index] = true;
+
+    std::vector<LeafField> leaves;
+    const EmittedType& type = emitted_types[index];
+
+    for (auto& parent : type.parents) {
+        auto it = data.type_indices.find(parent.type_name);
+        if (it == data.type_indices.end() || it->second == index || parent.offset == "UNKNOWN_OFFSET") continue;
+
+        collect_leaves(it->second, data);
+        for (auto& leaf : data.leaves[it->second]) {
+            leaves.push_back({ offset_leaf(parent.offset, leaf.offset), leaf.field, leaf.type_index, leaf.size });
+        }
+    }
+
+    for (size_t i = 0; i < type.fields.size(); i++) {
+        const EmittedField& field = type.fields[i];
+        std::string offset = std::to_string(field.offset);
+
+        // Bitfields and references aren't stored inline
+        size_t record = (field.bit_width == 0 && field.size != "0") ? find_record_index(data, field) : SIZE_MAX;
+
+        if (record != SIZE_MAX && record != index) {
+            collect_leaves(record, data);
+            for (auto& leaf : data.leaves[record]) {
+                leaves.push_back({ offset_leaf(offset, leaf.offset), leaf.field, leaf.type_index, leaf.size });
+            }
+        } else {
+            std::string type_index = find_type_index(data.type_indices, field.type_name, field.canonical_type_name);
+            std::string size = (field.bit_width == 0) ? field.size : "0";
+
+            leaves.push_back({ offset, data.first_fields[index] + i, type_index, size });
+        }
+    }
+
+    data.leaves[index] = std::move(leaves);
+}
+
+void emit_compact_tables(std::ostream& output) {
+    std::unordered_map<std::string, size_t> type_indices = get_type_indices();
+
+    auto get_type_index = [&](const EmittedField& field) {
+        return find_type_index(type_indices, field.type_name, field.canonical_type_name);
+    };
+
+    LeafData leaf_data;
+    leaf_data.type_indices = type_indices;
+    leaf_data.leaves.resize(emitted_types.size());
+    leaf_data.collected.resize(emitted_types.size(), false);
+
+    size_t field_count = 0;
+    for (auto& type : emitted_types) {
+        leaf_data.first_fields.push_back(field_count);
+        field_count += type.fields.size();
+    }
+
+    for (size_t i = 0; i < emitted_types.size(); i++) {
+        collect_leaves(i, leaf_data);
+    }
+
+    // Hot tables
+    output << "static const CompactType COMPACT_TYPES[] = {\n";
+
+    size_t leaf_count = 0;
+    for (size_t i = 0; i < emitted_types.size(); i++) {
+        output <<
+            "    { " << emitted_types[i].size << ", " << leaf_data.first_fields[i] << ", " << emitted_types[i].fields.size() <<
+            ", " << leaf_count << ", " << leaf_data.leaves[i].size() << " },\n";
+        leaf_count += leaf_data.leaves[i].size();
+    }
+
+    output <<
+        "};\n\n"
+        "static const uint32_t COMPACT_TYPE_COUNT = " << emitted_types.size() << ";\n"
+        "static const uint32_t COMPACT_FIELD_COUNT = " << field_count << ";\n"
+        "static const uint32_t COMPACT_LEAF_COUNT = " << leaf_count << ";\n\n";
+
+    // Zero-length arrays aren't allowed, so every field table gets a trailing zero
+    output << "static const uint32_t COMPACT_FIELD_OFFSETS[] = {\n";
+    for (auto& type : emitted_types) {
+        for (auto& field : type.fields) {
+            output << "    " << field.offset << ",\n";
+        }
+    }
+
+    output << "    0\n};\n\nstatic const uint32_t COMPACT_FIELD_SIZES[] = {\n";
+    for (auto& type : emitted_types) {
+        for (auto& field : type.fields) {
+            // Bitfields can't be copied by their offset
+            output << "    " << ((field.bit_width == 0) ? field.size : "0") << ",\n";
+        }
+    }
+
+    output << "    0\n};\n\nstatic const uint32_t COMPACT_FIELD_TYPES[] = {\n";
+    for (auto& type : emitted_types) {
+        for (auto& field : type.fields) {
+            output << "    " << get_type_index(field) << ",\n";
+        }
+    }
+
+    output << "    0\n};\n\n";
+
+    // The same for every leaf, the fields of the parents come first in the order they are declared.
+    // Leaf offsets can contain `base_offset`, which isn't a constant expression, so they're built on first use
+    output <<
+        "// Built on first use, so it can be used during the static initialization of other translation units\n"
+        "inline const uint32_t* get_compact_leaf_offsets() {\n"
+        "    static const uint32_t offsets[] = {\n";
+    for (auto& leaves : leaf_data.leaves) {
+        for (auto& leaf : leaves) {
+            output << "        " << leaf.offset << ",\n";
+        }
+    }
+
+    output << "        0\n    };\n\n    return offsets;\n}\n\nstatic const uint32_t COMPACT_LEAF_SIZES[] = {\n";
+    for (auto& leaves : leaf_data.leaves) {
+        for (auto& leaf : leaves) {
+            output << "    " << leaf.size << ",\n";
+        }
+    }
+
+    output << "    0\n};\n\nstatic const uint32_t COMPACT_LEAF_TYPES[] = {\n";
+    for (auto& leaves : leaf_data.leaves) {
+        for (auto& leaf : leaves) {
+            output << "    " << leaf.type_index << ",\n";
+        }
+    }
+
+    output << "    0\n};\n\nstatic const uint32_t COMPACT_LEAF_FIELDS[] = {\n";
+    for (auto& leaves : leaf_data.leaves) {
+        for (auto& leaf : leaves) {
+            output << "    " << leaf.field << ",\n";
+        }
+    }
+
+    // Cold tables
+    output << "    0\n};\n\n";
+
+    size_t tag_index = 0;
+    for (auto& type : emitted_types) {
+        for (auto& field : type.fields) {
+            if (field.tags.empty()) continue;
+
+            output << "static const char* const compact_tags_" << tag_index++ << "[] = { ";
+            for (auto& tag : field.tags) {
+                output << "\"" << tag << "\", ";
+            }
+            output << "};\n";
+        }
+    }
+
+    output << "\nstatic const CompactFieldCold COMPACT_FIELDS_COLD[] = {\n";
+
+    tag_index = 0;
+    for (auto& type : emitted_types) {
+        for (auto& field : type.fields) {
+            std::string tags = "nullptr";
+            if (!field.tags.empty()) {
+                tags = "compact_tags_" + std::to_string(tag_index++);
+            }
+
+            output <<
+                "    { \"" << field.name << "\", " << field.bit_width << ", " << field.bit_shift <<
+                ", RecordAccess::" << field.access << ", " << field.tags.size() << ", " << tags << " },\n";
+        }
+    }
+
+    output << "    { \"\", 0, 0, RecordAccess::Public, 0, nullptr }\n};\n";
+}
+
+// Offsets along an inheritance path add up, unless one of them isn't known
+static std::string add_offsets(const std::string& a, const std::string& b) {
+    if (a == "UNKNOWN_OFFSET" || b == "UNKNOWN_OFFSET") return "UNKNOWN_OFFSET";
+
+    return a + " + " + b;
+}
+
+typedef std::vector<std::vector<std::pair<size_t, std::string>>> ParentList;
+
+// Collects every ancestor of `index` with the offset it has in `index`
+static void collect_ancestors(size_t index, const ParentList& parents, std::vector<std::map<size_t, std::string>>& ancestors,
+                              std::vector<bool>& collected) {
+    if (collected[index]) return;
+    collected[index] = true;
+
+    auto add_ancestor = [&](size_t ancestor, const std::string& offset) {
+        auto it = ancestors[index].find(ancestor);
+
+        if (it == ancestors[index].end()) {
+            ancestors[index].insert({ ancestor, offset });
+        } else if (it->second != offset) {
+            // Reachable through more than one path, so a `static_cast` would be ambiguous
+            it->second = "UNKNOWN_OFFSET";
+        }
+    };
+
+    for (auto& parent : parents[index]) {
+        collect_ancestors(parent.first, parents, ancestors, collected);
+
+        add_ancestor(parent.first, parent.second);
+        for (auto& ancestor : ancestors[parent.first]) {
+            add_ancestor(ancestor.first, add_offsets(parent.second, ancestor.second));
+        }
+    }
+}
+
+struct HierarchyNumbering {
+    std::vector<std::vector<size_t>> children;
+    std::vector<uint32_t> pre;
+    std::vector<uint32_t> post;
+    uint32_t counter = 0;
+};
+
+static void number_hierarchy(size_t index, HierarchyNumbering& numbering) {
+    numbering.pre[index] = numbering.counter++;
+
+    for (size_t child : numbering.children[index]) {
+        number_hierarchy(child, numbering);
+    }
+
+    numbering.post[index] = numbering.counter++;
+}
+
+void emit_hierarchy_tables(std::ostream& output) {
+    std::unordered_map<std::string, size_t> type_indices = get_type_indices();
+    size_t type_count = emitted_types.size();
+
+    // Only indexed parents can be numbered, a type with any other parent (e.g. a template) is partial
+    ParentList parents(type_count);
+    std::vector<bool> partial(type_count, false);
+
+    for (size_t i = 0; i < type_count; i++) {
+        for (auto& parent : emitted_types[i].parents) {
+            auto it = type_indices.find(parent.type_name);
+
+            if (it != type_indices.end() && it->second != i) {
+                parents[i].push_back({ it->second, parent.offset });
+            } else {
+                partial[i] = true;
+            }
+        }
+    }
+
+    std::vector<std::map<size_t, std::string>> ancestors(type_count);
+    std::vector<bool> collected(type_count, false);
+
+    for (size_t i = 0; i < type_count; i++) {
+        collect_ancestors(i, parents, ancestors, collected);
+    }
+
+    // The first parent of every type forms a forest, a pre/post numbering of it turns every
+    // single-inheritance check into two comparisons
+    HierarchyNumbering numbering;
+    numbering.children.resize(type_count);
+    numbering.pre.resize(type_count);
+    numbering.post.resize(type_count);
+
+    for (size_t i = 0; i < type_count; i++) {
+        if (!parents[i].empty()) {
+            numbering.children[parents[i][0].first].push_back(i);
+        }
+    }
+
+    for (size_t i = 0; i < type_count; i++) {
+        if (parents[i].empty()) {
+            number_hierarchy(i, numbering);
+        }
+    }
+
+    output << "static const HierarchyNode HIERARCHY_NODES[] = {\n";
+
+    size_t ancestor_count = 0;
+    for (size_t i = 0; i < type_count; i++) {
+        // Ancestors off the first-parent chain need the ancestor list, partial types need a walk over the parents
+        bool multiple = false;
+        for (auto& ancestor : ancestors[i]) {
+            partial[i] = partial[i] || partial[ancestor.first];
+            multiple = multiple || parents[ancestor.first].size() > 1;
+        }
+        multiple = multiple || parents[i].size() > 1;
+
+        std::vector<std::string> flag_names;
+        if (multiple) flag_names.push_back("HIERARCHY_MULTIPLE");
+        if (partial[i]) flag_names.push_back("HIERARCHY_PARTIAL");
+        if (emitted_types[i].type_kind == "Record") {
+            flag_names.push_back("(std::is_polymorphic<" + emitted_types[i].qualified_name + ">::value ? HIERARCHY_POLYMORPHIC : 0)");
+        }
+
+        std::string flags = flag_names.empty() ? "0" : flag_names[0];
+        for (size_t f = 1; f < flag_names.size(); f++) {
+            flags += " | " + flag_names[f];
+        }
+
+        output <<
+            "    { " << numbering.pre[i] << ", " << numbering.post[i] << ", " << ancestor_count << ", " <<
+            ancestors[i].size() << ", " << flags << " },\n";
+
+        ancestor_count += ancestors[i].size();
+    }
+
+    output <<
+        "};\n\n"
+        "static const uint32_t HIERARCHY_ANCESTOR_COUNT = " << ancestor_count << ";\n\n";
+
+    // Sorted by type index within each type so they can be binary searched.
+    // The offsets can contain `base_offset`, so the same as the leaf offsets it's built on first use
+    output <<
+        "// Built on first use, so `is_a` and `dyn_cast` work during the static initialization of other translation units\n"
+        "inline const HierarchyAncestor* get_hierarchy_ancestors() {\n"
+        "    static const HierarchyAncestor ancestors[] = {\n";
+    for (size_t i = 0; i < type_count; i++) {
+        for (auto& ancestor : ancestors[i]) {
+            output << "        { " << ancestor.first << ", " << ancestor.second << " },\n";
+        }
+    }
+
+    output << "        { INVALID_TYPE_INDEX, UNKNOWN_OFFSET }\n    };\n\n    return ancestors;\n}\n";
+}
+
+void emit_dynamic_types(std::ostream& output) {
+    output <<
+        "// Adds the vtables of every generated polymorphic type that's tagged `DynamicType`\n"
+        "inline void add_all_dynamic_types(std::vector<DynamicTypeEntry>& entries) {\n";
+
+    for (size_t i = 0; i < emitted_types.size(); i++) {
+        const std::vector<std::string>& tags = emitted_types[i].tags;
+        bool included = std::find(tags.begin(), tags.end(), "DynamicType") != tags.end();
+
+        if (emitted_types[i].type_kind == "Record" && included) {
+            output << "    add_dynamic_type<" << emitted_types[i].qualified_name << ">(entries, " << i << ");\n";
+        }
+    }
+
+    output << "}\n";
+}
+
+void emit_type_table(std::ostream& output) {
+    std::unordered_map<std::string, size_t> type_indices = get_type_indices();
+
+    // All names are stored in one blob and referred to by their offset
+    std::vector<std::string> strings;
+    std::unordered_map<std::string, size_t> string_offsets;
+    size_t strings_size = 0;
+
+    auto add_string = [&](const std::string& str) {
+        auto it = string_offsets.find(str);
+        if (it != string_offsets.end()) return it->second;
+
+        size_t offset = strings_size;
+        string_offsets.insert({ str, offset });
+        strings.push_back(str);
+        strings_size += str.size() + 1;
+
+        return offset;
+    };
+
+    output << "static const TableType TYPE_TABLE_TYPES[] = {\n";
+
+    size_t parent_count = 0;
+    size_t field_count = 0;
+    size_t enum_count = 0;
+    for (auto& type : emitted_types) {
+        output <<
+            "    { TypeInfoType::" << type.type_kind << ", " << type.subtype << ", " << add_string(type.type_name) <<
+            ", " << type.type_id << "u, " << type.size << ", " << find_type_index(type_indices, type.underlying) <<
+            ", " << type.length <<
+            ", " << parent_count << ", " << type.parents.size() <<
+            ", " << field_count << ", " << type.fields.size() <<
+            ", " << enum_count << ", " << type.enums.size() << " },\n";
+
+        parent_count += type.parents.size();
+        field_count += type.fields.size();
+        enum_count += type.enums.size();
+    }
+
+    // Zero-length arrays aren't allowed, so every table gets a trailing empty entry
+    output << "    { TypeInfoType::Primitive, 0, 0, 0, 0, INVALID_TYPE_INDEX, 0, 0, 0, 0, 0, 0, 0 }\n};\n\n";
+
+    // Parent offsets can contain `base_offset`, which isn't a constant expression, so they're built on first use
+    output <<
+        "inline const TableParent* get_type_table_parents() {\n"
+        "    static const TableParent parents[] = {\n";
+    for (auto& type : emitted_types) {
+        for (auto& parent : type.parents) {
+            output << "        { " << find_type_index(type_indices, parent.type_name) << ", " << parent.offset << " },\n";
+        }
+    }
+
+    output <<
+        "        { INVALID_TYPE_INDEX, UNKNOWN_OFFSET }\n    };\n\n    return parents;\n}\n\n"
+        "static const TableField TYPE_TABLE_FIELDS[] = {\n";
+    for (auto& type : emitted_types) {
+        for (auto& field : type.fields) {
+            output <<
+                "    { " << add_string(field.name) << ", " <<
+                find_type_index(type_indices, field.type_name, field.canonical_type_name) << ", " <<
+                field.offset << ", " << ((field.bit_width == 0) ? field.size : "0") << ", " <<
+                field.bit_width << ", " << field.bit_shift << ", RecordAccess::" << field.access << " },\n";
+        }
+    }
+
+    output << "    { 0, INVALID_TYPE_INDEX, 0, 0, 0, 0, RecordAccess::Public }\n};\n\nstatic const TableEnum TYPE_TABLE_ENUMS[] = {\n";
+    for (auto& type : emitted_types) {
+        for (auto& pair : type.enums) {
+            output << "    { " << add_string(pair.first) << ", " << pair.second << " },\n";
+        }
+    }
+
+    output << "    { 0, 0 }\n};\n\nstatic const char TYPE_TABLE_STRINGS[] =\n";
+    for (auto& str : strings) {
+        output << "    \"" << str << "\\0\"\n";
+    }
+
+    output <<
+        "    \"\";\n\n"
+        "static const uint32_t TYPE_TABLE_TYPE_COUNT = " << emitted_types.size() << ";\n"
+        "static const uint32_t TYPE_TABLE_PARENT_COUNT = " << parent_count << ";\n"
+        "static const uint32_t TYPE_TABLE_FIELD_COUNT = " << field_count << ";\n"
+        "static const uint32_t TYPE_TABLE_ENUM_COUNT = " << enum_count << ";\n"
+        "static const uint32_t TYPE_TABLE_STRINGS_SIZE = " << strings_size << ";\n";
+}
+
 void emit_template_record(std::ostream& output, CXCursor cursor, std::vector<std::string>& args) {
     if (std::find(args.begin(), args.end(), "DoNotIndex") != args.end()) {
         return;
@@ -233,7 +1141,7 @@ void emit_template_record(std::ostream& output, CXCursor cursor, std::vector<std
             case CXCursor_NonTypeTemplateParameter:
                 td->templates.push_back(c);
 
-                ClangStr type = clang_getTypeSpelling(clang_getCursorType(c));
+                const std::string& type = get_type_spelling(clang_getCursorType(c));
                 td->template_type.push_back(type.c_str());
                 break;
         }
@@ -263,11 +1171,18 @@ void emit_template_record(std::ostream& output, CXCursor cursor, std::vector<std
 
     emit_common_start(output, "Record", type_name, qualified_name, template_decl);
 
-    output << "            type.size = sizeof(" << qualified_name << ");\n\n";
+    output << "            type.size = sizeof(" << qualified_name << ");\n";
+    emit_lifecycle(output, qualified_name, args);
 
     emit_record_generic(output, cursor, args, qualified_name.c_str(), template_decl);
 }
 
+void emit_lifecycle(std::ostream& output, const std::string& qualified_name, const std::vector<std::string>& args) {
+    bool copyable = std::find(args.begin(), args.end(), "NoCopy") == args.end();
+
+    output << "            init_lifecycle<" << qualified_name << (copyable ? "" : ", false") << ">(type);\n\n";
+}
+
 void emit_record(std::ostream& output, CXCursor cursor, std::vector<std::string>& args) {
     if (std::find(args.begin(), args.end(), "DoNotIndex") != args.end()) {
         return;
@@ -275,18 +1190,27 @@ void emit_record(std::ostream& output, CXCursor cursor, std::vector<std::string>
 
     CXType type = clang_getCursorType(cursor);
     ClangStr type_name = clang_getCursorSpelling(cursor);
-    ClangStr qualified_name = clang_getTypeSpelling(type);
+    const std::string& qualified_name = get_type_spelling(type);
 
     emit_common_start(output, "Record", type_name.c_str(), qualified_name.c_str());
 
-    output << "            type.size = sizeof(" << qualified_name.c_str() << ");\n\n";
+    output << "            type.size = sizeof(" << qualified_name.c_str() << ");\n";
+    emit_lifecycle(output, qualified_name, args);
+    emitted_types.back().size = std::string("sizeof(") + qualified_name.c_str() + ")";
 
     emit_record_generic(output, cursor, args, qualified_name.c_str(), "");
 }
 
 void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std::string>& args,
                          std::string qualified_name, std::string template_decl) {
-    emit_tags(output, cursor, args);
+    // `emit_common_start` has just added the record if it's not a template
+    size_t record_index = emitted_types.size() - 1;
+
+    std::vector<std::string> tags = emit_tags(output, cursor, args);
+
+    if (template_decl.empty()) {
+        emitted_types[record_index].tags = tags;
+    }
 
     std::string record_type = "Struct";
 
@@ -302,8 +1226,13 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
 
     output << "            type.record_type = RecordType::" << record_type << ";\n";
 
+    if (template_decl.empty()) {
+        emitted_types[record_index].subtype = "(uint8_t)RecordType::" + record_type;
+    }
+
     struct RecordData {
         std::vector<std::string> parents;
+        std::vector<CXCursor> parent_cursors;
         std::vector<CXCursor> fields;
         std::vector<CXCursor> methods;
     } data;
@@ -313,8 +1242,17 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
 
         switch (clang_getCursorKind(c)) {
             case CXCursor_CXXBaseSpecifier: {
-                ClangStr qualified_name = clang_getTypeSpelling(clang_getCursorType(c));
-                rd->parents.push_back(qualified_name.c_str());
+                // Spelled like field types, the written spelling of a base can skip its namespace
+                CXType cursor_type = clang_getCursorType(c);
+                CXType spelled_type = get_canonical_type(cursor_type);
+                std::string prefix = "";
+                if (get_deepest_type(cursor_type).kind == CXType_Unexposed) {
+                    prefix = get_namespace(get_type_declaration(spelled_type));
+                    spelled_type = cursor_type;
+                }
+
+                rd->parents.push_back(prefix + get_type_spelling(spelled_type));
+                rd->parent_cursors.push_back(c);
                 break;
             }
 
@@ -355,9 +1293,32 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
             output << "            parents[" << i << "] = type_of<" << data.parents[i] << ">();\n";
         }
 
-        output << "\n            type.parents = parents;";
+        output << "\n            type.parents = parents;\n";
+
+        // The pointer adjustment of a virtual base is only known at runtime and we can't
+        // `static_cast` to an inaccessible base, so those are marked as unknown
+        output << "            static uint32_t parent_offsets[" << data.parents.size() << "];\n";
+
+        for (int i = 0; i < data.parents.size(); i++) {
+            CXCursor parent = data.parent_cursors[i];
+
+            std::string offset = "UNKNOWN_OFFSET";
+            if (!clang_isVirtualBase(parent) && clang_getCXXAccessSpecifier(parent) == CX_CXXPublic) {
+                offset = "base_offset<" + qualified_name + ", " + data.parents[i] + ">()";
+            }
+
+            output << "            parent_offsets[" << i << "] = " << offset << ";\n";
+
+            if (template_decl.empty()) {
+                emitted_types[record_index].parents.push_back({ data.parents[i], offset });
+            }
+        }
+
+        output << "\n            type.parent_offsets = parent_offsets;";
     } else {
-        output << "            type.parents = nullptr;\n";
+        output <<
+            "            type.parents = nullptr;\n"
+            "            type.parent_offsets = nullptr;\n";
     }
 
     output << "\n            type.field_count = " << data.fields.size() << ";\n";
@@ -372,20 +1333,22 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
 
             // If the type is a template parameter then the canonical type is something like
             // type-parameter-0-0 instead of simply T
-            CXType field_type = get_deepest_type(cursor_type);
+            CXType deepest_type = get_deepest_type(cursor_type);
+            CXType spelled_type = get_canonical_type(cursor_type);
             std::string prefix = "";
-            if (field_type.kind == CXType_Unexposed) {
-                field_type = cursor_type;
-
-                CXCursor decl = clang_getTypeDeclaration(clang_getCanonicalType(field_type));
+            if (deepest_type.kind == CXType_Unexposed) {
+                CXCursor decl = get_type_declaration(spelled_type);
                 prefix = get_namespace(decl);
+                spelled_type = cursor_type;
             }
 
-            ClangStr field_name = clang_getTypeSpelling(field_type);
+            // Newer versions of clang spell types as they were written, so outside of templates the
+            // canonical type is used to get the namespace
+            const std::string& field_name = get_type_spelling(spelled_type);
             ClangStr name = clang_getCursorSpelling(data.fields[i]);
 
             // We can't call type_of on an anonymous declaration
-            CXCursor decl = clang_getTypeDeclaration(field_type);
+            CXCursor decl = get_type_declaration(deepest_type);
             if (clang_Cursor_isAnonymous(decl) ||
                 clang_Cursor_isAnonymousRecordDecl(decl)) {
                 output << "            fields[" << i << "].type_info = &UNINDEXED_TYPE_INFO;\n";
@@ -399,15 +1362,28 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
             get_args(data.fields[i], field_args);
 
             std::string i_str = std::to_string(i);
-            emit_tags(output, data.fields[i], field_args, "fields[" + i_str + "]", "tags_" + i_str);
+            std::vector<std::string> field_tags =
+                emit_tags(output, data.fields[i], field_args, "fields[" + i_str + "]", "tags_" + i_str);
 
+            // For bitfields the offset is the first byte that contains the field
+            // and the remaining bits are stored in `bit_shift`
             long long offset = clang_Cursor_getOffsetOfField(data.fields[i]);
             output << "            fields[" << i << "].offset = " << offset / 8 << ";\n";
 
+            if (clang_Cursor_isBitField(data.fields[i])) {
+                output <<
+                    "            fields[" << i << "].bit_width = " << clang_getFieldDeclBitWidth(data.fields[i]) << ";\n"
+                    "            fields[" << i << "].bit_shift = " << offset % 8 << ";\n";
+            } else {
+                output <<
+                    "            fields[" << i << "].bit_width = 0;\n"
+                    "            fields[" << i << "].bit_shift = 0;\n";
+            }
+
             std::string access = "Public";
             switch (clang_getCXXAccessSpecifier(data.fields[i])) {
                 case CX_CXXPrivate:
-                    access = "Public";
+                    access = "Private";
                     break;
 
                 case CX_CXXProtected:
@@ -415,9 +1391,36 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
                     break;
             }
 
-            output << "            fields[" << i << "].access = RecordAccess::" << access << ";\n\n";
+            output << "            fields[" << i << "].access = RecordAccess::" << access << ";\n";
+
+            if (template_decl.empty()) {
+                EmittedField field;
+                field.name = name.c_str();
+                field.type_name = prefix + field_name.c_str();
+                field.canonical_type_name = get_type_spelling(get_canonical_type(cursor_type));
+                field.offset = offset / 8;
+                field.bit_width = clang_Cursor_isBitField(data.fields[i]) ? clang_getFieldDeclBitWidth(data.fields[i]) : 0;
+                field.bit_shift = clang_Cursor_isBitField(data.fields[i]) ? offset % 8 : 0;
+                field.access = access;
+                field.tags = field_tags;
+
+                // Anonymous types can't be named, so we take the size that clang calculated.
+                // References aren't stored inline so they get no size, just like bitfields
+                if (cursor_type.kind == CXType_LValueReference || cursor_type.kind == CXType_RValueReference) {
+                    field.size = "0";
+                } else if (clang_Cursor_isAnonymous(decl) || clang_Cursor_isAnonymousRecordDecl(decl)) {
+                    field.size = std::to_string(clang_Type_getSizeOf(cursor_type));
+                } else {
+                    field.size = "sizeof(" + field.type_name + ")";
+                }
+
+                emitted_types[record_index].fields.push_back(field);
+            }
+
+            emit_field_accessors(output, data.fields[i], cursor_type, "fields[" + i_str + "]", qualified_name);
+            output << "\n";
 
-            add_nested_types(field_type);
+            add_nested_types(cursor_type);
         }
 
         output << "            type.fields = fields;\n\n";
@@ -432,14 +1435,14 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
 
         for (int i = 0; i < data.methods.size(); i++) {
             // We're getting the canonical type for the same reason as with the fields
-            CXType method_type = clang_getCanonicalType(clang_getCursorType(data.methods[i]));
-            CXType return_type = clang_getCanonicalType(clang_getResultType(method_type));
+            CXType method_type = get_canonical_type(clang_getCursorType(data.methods[i]));
+            CXType return_type = get_canonical_type(clang_getResultType(method_type));
 
             add_nested_types(return_type);
 
-            ClangStr type_name = clang_getTypeSpelling(method_type);
+            const std::string& type_name = get_type_spelling(method_type);
             ClangStr name = clang_getCursorSpelling(data.methods[i]);
-            ClangStr return_type_qualified = clang_getTypeSpelling(return_type);
+            const std::string& return_type_qualified = get_type_spelling(return_type);
 
 
             output <<
@@ -513,7 +1516,12 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
                 std::string func_args = "";
 
                 clang_visitChildren(method, [](CXCursor c, CXCursor parent, CXClientData data) {
-                    ClangStr qualified_name = clang_getTypeSpelling(clang_getCursorType(c));
+                    // The return type and body are children too
+                    if (clang_getCursorKind(c) != CXCursor_ParmDecl) {
+                        return CXChildVisit_Continue;
+                    }
+
+                    const std::string& qualified_name = get_type_spelling(clang_getCursorType(c));
 
                     std::string& func_args = (*(std::string*)data);
 
@@ -525,7 +1533,7 @@ void emit_record_generic(std::ostream& output, CXCursor cursor, std::vector<std:
                     return CXChildVisit_Continue;
                 }, &func_args);
 
-                ClangStr return_value = clang_getTypeSpelling(clang_getResultType(clang_getCursorType(method)));
+                const std::string& return_value = get_type_spelling(clang_getResultType(clang_getCursorType(method)));
 
                 output <<
                     "            if (Callable<" << qualified_name << ", Result, Args...>().valid("
@@ -560,11 +1568,13 @@ void emit_enum(std::ostream& output, CXCursor cursor, std::vector<std::string>&
 
     CXType type = clang_getCursorType(cursor);
     ClangStr type_name = clang_getCursorSpelling(cursor);
-    ClangStr qualified_name = clang_getTypeSpelling(type);
+    const std::string& qualified_name = get_type_spelling(type);
 
     emit_common_start(output, "Enum", type_name.c_str(), qualified_name.c_str());
 
-    output << "            type.size = sizeof(" << qualified_name.c_str() << ");\n\n";
+    output << "            type.size = sizeof(" << qualified_name.c_str() << ");\n";
+    emit_lifecycle(output, qualified_name, args);
+    emitted_types.back().size = std::string("sizeof(") + qualified_name.c_str() + ")";
 
     emit_tags(output, cursor, args);
 
@@ -606,7 +1616,10 @@ void emit_enum(std::ostream& output, CXCursor cursor, std::vector<std::string>&
     }, &data);
 
     CXType underlying = clang_getEnumDeclIntegerType(cursor);
-    ClangStr underlying_name = clang_getTypeSpelling(underlying);
+    const std::string& underlying_name = get_type_spelling(underlying);
+
+    emitted_types.back().underlying = underlying_name.c_str();
+    emitted_types.back().enums = data.enums;
 
     output <<
         "            type.underlying = type_of<" << underlying_name.c_str() << ">();\n"
@@ -640,7 +1653,7 @@ void emit_function(std::ostream& output, CXCursor cursor, std::vector<std::strin
     }
 
     CXType type = clang_getCursorType(cursor);
-    ClangStr qualified_name = clang_getTypeSpelling(type);
+    const std::string& qualified_name = get_type_spelling(type);
 
     if (emitted_functions.find(qualified_name.c_str()) != emitted_functions.end()) {
 
@@ -654,8 +1667,8 @@ void emit_function(std::ostream& output, CXCursor cursor, std::vector<std::strin
 
     emitted_functions.insert({ qualified_name.c_str(), name.c_str() });
 
-    ClangStr type_name = clang_getTypeSpelling(type);
-    ClangStr return_type_qualified = clang_getTypeSpelling(clang_getResultType(type));
+    const std::string& type_name = get_type_spelling(type);
+    const std::string& return_type_qualified = get_type_spelling(clang_getResultType(type));
 
     emit_common_start(output, "Function", type_name.c_str(), qualified_name.c_str());
 
@@ -679,16 +1692,37 @@ void emit_common_start(std::ostream& output, std::string type_kind, std::string
         suffix = type_kind;
     }
 
+    std::string type_index = "INVALID_TYPE_INDEX";
+
+    if (template_args.empty()) {
+        type_index = std::to_string(emitted_types.size());
+        emitted_types.emplace_back();
+
+        EmittedType& emitted = emitted_types.back();
+        emitted.qualified_name = qualified_type_name;
+        emitted.type_kind = type_kind;
+        emitted.type_name = type_name;
+        emitted.type_id = std::hash<std::string>{}(qualified_type_name.c_str());
+    }
+
     output <<
         "template<" << template_args << ">\n"
         "struct Type<" << qualified_type_name << "> {\n"
         "    static const TypeInfo* info() {\n"
-        "        static TypeInfo" << suffix << " type;\n\n"
+        "        static TypeInfo" << suffix << " type;\n"
+        "        static type_init_state_t state;\n\n"
 
-        "        if (type.type_id == 0) {\n"
+        "        if (state.load(std::memory_order_acquire) == TYPE_READY) {\n"
+        "            return &type;\n"
+        "        }\n\n"
+
+        "        TypeInitGuard guard(state);\n\n"
+
+        "        if (guard.should_init()) {\n"
         "            type.type = TypeInfoType::" << type_kind << ";\n"
         "            type.type_name = \"" << type_name << "\";\n"
-        "            type.type_id = " << std::hash<std::string>{}(qualified_type_name.c_str()) << ";\n";
+        "            type.type_id = " << std::hash<std::string>{}(qualified_type_name.c_str()) << ";\n"
+        "            type.type_index = " << type_index << ";\n";
 }
 
 void emit_common_end(std::ostream& output) {
@@ -698,12 +1732,12 @@ void emit_common_end(std::ostream& output) {
         "    }\n";
 }
 
-void emit_tags(std::ostream& output, CXCursor cursor, std::vector<std::string>& args,
-               std::string lhs, std::string array_name) {
+std::vector<std::string> emit_tags(std::ostream& output, CXCursor cursor, std::vector<std::string>& args,
+                                   std::string lhs, std::string array_name) {
     std::vector<std::string> tags;
 
-    for (int i = 0; i < args.size(); i++) {
-        if (args[i].compare("Tags=")) {
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i].compare(0, 5, "Tags=") == 0) {
             args[i].erase(args[i].begin(), args[i].begin() + 5);
 
             std::stringstream ss(args[i]);
@@ -732,6 +1766,8 @@ void emit_tags(std::ostream& output, CXCursor cursor, std::vector<std::string>&
             "            " << lhs << ".tag_count = 0;\n"
             "            " << lhs << ".tags = nullptr;\n";
     }
+
+    return tags;
 }
 
 void emit_parameters(std::ostream& output, CXCursor cursor, std::string lhs, std::string array_name) {
@@ -755,7 +1791,7 @@ void emit_parameters(std::ostream& output, CXCursor cursor, std::string lhs, std
             if (kind != CXCursor_ParmDecl) return CXChildVisit_Continue;
 
             CXType type = clang_getCursorType(c);
-            ClangStr qualified_name = clang_getTypeSpelling(clang_getCursorType(c));
+            const std::string& qualified_name = get_type_spelling(clang_getCursorType(c));
             ClangStr name = clang_getCursorSpelling(c);
 
             ParamData* pd = (ParamData*)data;
@@ -774,6 +1810,64 @@ void emit_parameters(std::ostream& output, CXCursor cursor, std::string lhs, std
     }
 }
 
+void emit_field_accessors(std::ostream& output, CXCursor field, CXType field_type, std::string lhs,
+                          std::string qualified_name) {
+    ClangStr name = clang_getCursorSpelling(field);
+
+    // We can only name public fields from outside the record and references
+    // can't be copied through their address
+    if (clang_getCXXAccessSpecifier(field) != CX_CXXPublic || strlen(name.c_str()) == 0 ||
+        field_type.kind == CXType_LValueReference || field_type.kind == CXType_RValueReference) {
+        output <<
+            "            " << lhs << ".get = nullptr;\n"
+            "            " << lhs << ".set = nullptr;\n";
+        return;
+    }
+
+    std::string object = "((" + qualified_name + "*)object)->" + name.c_str();
+    std::string const_object = "((const " + qualified_name + "*)object)->" + name.c_str();
+    std::string copy_mode = "FieldCopyModeOf<decltype(((const " + qualified_name + "*)nullptr)->" + name.c_str() + ")>::value";
+
+    if (clang_Cursor_isBitField(field)) {
+        // Bitfields have no address so they go through a temporary of the declared type
+        output <<
+            "            " << lhs << ".get = [](const void* object, void* out) {\n"
+            "                auto value = " << const_object << ";\n"
+            "                memcpy(out, &value, sizeof(value));\n"
+            "            };\n";
+    } else {
+        // Fields that aren't trivially copyable (e.g. `std::string`) are copy constructed into `out`
+        output <<
+            "            " << lhs << ".get = (" << copy_mode << " == FieldCopyMode::None) ? nullptr :\n"
+            "                (field_getter_t)[](const void* object, void* out) {\n"
+            "                    FieldCopy<decltype(" << const_object << ")>::get(out, " << const_object << ");\n"
+            "                };\n";
+    }
+
+    // Arrays of const elements can't be assigned either
+    CXType element_type = field_type;
+    while (element_type.kind == CXType_ConstantArray) {
+        element_type = clang_getElementType(element_type);
+    }
+
+    if (clang_isConstQualifiedType(field_type) || clang_isConstQualifiedType(element_type)) {
+        output << "            " << lhs << ".set = nullptr;\n";
+    } else if (clang_Cursor_isBitField(field)) {
+        output <<
+            "            " << lhs << ".set = [](void* object, const void* in) {\n"
+            "                decltype(" << object << ") value;\n"
+            "                memcpy(&value, in, sizeof(value));\n"
+            "                " << object << " = value;\n"
+            "            };\n";
+    } else {
+        output <<
+            "            " << lhs << ".set = (" << copy_mode << " == FieldCopyMode::None) ? nullptr :\n"
+            "                (field_setter_t)[](void* object, const void* in) {\n"
+            "                    FieldCopy<decltype(" << object << ")>::set(" << object << ", in);\n"
+            "                };\n";
+    }
+}
+
 void add_nested_types(CXType type) {
     bool any_added = false;
     any_added |= add_nested_types(type, CXType_ConstantArray, clang_getElementType);
@@ -787,6 +1881,19 @@ void add_nested_types(CXType type) {
     if (any_added) {
         add_primitive_type(type);
     }
+
+    // The element type of a standard container, e.g. the `char` of `std::string`,
+    // is only named by the template so it wouldn't be emitted otherwise
+    CXType canonical = get_canonical_type(type);
+    int argument_count = clang_Type_getNumTemplateArguments(canonical);
+
+    for (int i = 0; i < argument_count; i++) {
+        CXType argument = clang_Type_getTemplateArgumentAsType(canonical, i);
+        if (argument.kind == CXType_Invalid) continue;
+
+        add_nested_types(argument);
+        add_primitive_type(argument);
+    }
 }
 
 bool add_nested_types(CXType type, CXTypeKind kind, CXType(get_nested)(CXType)) {
@@ -848,14 +1955,61 @@ CXType get_deepest_type(CXType type) {
     return type;
 }
 
-std::string get_namespace(CXCursor decl) {
+const std::string& get_type_spelling(CXType type) {
+    auto it = type_cache.spellings.find(type);
+
+    if (it != type_cache.spellings.end()) {
+        type_cache.spelling_stats.hits += 1;
+        return it->second;
+    }
+
+    type_cache.spelling_stats.misses += 1;
+    return type_cache.spellings.insert({ type, ClangStr(clang_getTypeSpelling(type)).c_str() }).first->second;
+}
+
+CXType get_canonical_type(CXType type) {
+    auto it = type_cache.canonical_types.find(type);
+
+    if (it != type_cache.canonical_types.end()) {
+        type_cache.canonical_stats.hits += 1;
+        return it->second;
+    }
+
+    type_cache.canonical_stats.misses += 1;
+    return type_cache.canonical_types.insert({ type, clang_getCanonicalType(type) }).first->second;
+}
+
+CXCursor get_type_declaration(CXType type) {
+    auto it = type_cache.declarations.find(type);
+
+    if (it != type_cache.declarations.end()) {
+        type_cache.declaration_stats.hits += 1;
+        return it->second;
+    }
+
+    type_cache.declaration_stats.misses += 1;
+    return type_cache.declarations.insert({ type, clang_getTypeDeclaration(type) }).first->second;
+}
+
+const std::string& get_namespace(CXCursor decl) {
+    auto it = type_cache.namespaces.find(decl);
+
+    if (it != type_cache.namespaces.end()) {
+        type_cache.namespace_stats.hits += 1;
+        return it->second;
+    }
+
+    type_cache.namespace_stats.misses += 1;
+
     std::vector<std::string> hierarchy;
+    std::string prefix;
 
     CXCursor parent = clang_getCursorLexicalParent(decl);
     while (parent.kind != CXCursor_TranslationUnit) {
         if (parent.kind >= CXCursor_FirstInvalid &&
             parent.kind <= CXCursor_LastInvalid) {
-            return "";
+            hierarchy.clear();
+            break;
         }
 
         hierarchy.push_back(ClangStr(clang_getCursorSpelling(parent)).c_str());
@@ -865,12 +2019,20 @@ std::string get_namespace(CXCursor decl) {
 
     std::reverse(hierarchy.begin(), hierarchy.end());
 
-    std::string prefix;
     for (auto& step : hierarchy) {
         prefix += step + "::";
     }
 
-    return prefix;
+    return type_cache.namespaces.insert({ decl, prefix }).first->second;
+}
+
+std::vector<CacheStats> get_cache_stats() {
+    return {
+        type_cache.spelling_stats,
+        type_cache.canonical_stats,
+        type_cache.declaration_stats,
+        type_cache.namespace_stats
+    };
 }
 
 void create_primitive(CXType type, Primitive& p) {
@@ -878,7 +2040,7 @@ void create_primitive(CXType type, Primitive& p) {
 
     p.kind = type.kind;
 
-    p.qualified_type_name = ClangStr(clang_getTypeSpelling(type)).c_str();
+    p.qualified_type_name = get_type_spelling(type);
     p.type_name = p.qualified_type_name;
 
     if (p.type_name.find(':') != std::string::npos) {
@@ -887,14 +2049,14 @@ void create_primitive(CXType type, Primitive& p) {
 
     if (type.kind == CXType_ConstantArray) {
         p.array_length = clang_getArraySize(type);
-        p.underlying_name = ClangStr(clang_getTypeSpelling(clang_getElementType(type))).c_str();
+        p.underlying_name = get_type_spelling(clang_getElementType(type));
 
         p.deepest = std::make_shared<Primitive>();
         create_primitive(get_deepest_type(type), *p.deepest);
     } else if (type.kind == CXType_Pointer ||
                type.kind == CXType_LValueReference ||
                type.kind == CXType_RValueReference) {
-        p.underlying_name = ClangStr(clang_getTypeSpelling(clang_getPointeeType(type))).c_str();
+        p.underlying_name = get_type_spelling(clang_getPointeeType(type));
 
         p.deepest = std::make_shared<Primitive>();
         create_primitive(get_deepest_type(type), *p.deepest);
@@ -913,19 +2075,26 @@ void emit_primitive(std::ostream& output, const Primitive& type) {
     }
 
     emit_common_start(output, suffix, type.type_name, type.qualified_type_name);
+    output << "            type.primitive_kind = get_primitive_kind<" << type.qualified_type_name << ">();\n";
 
     // We can't do sizeof(void)
     if (type.qualified_type_name != "void" &&
         type.qualified_type_name != "const void") {
         output << "\n            type.size = sizeof(" << type.qualified_type_name << ");\n";
+        output << "            init_lifecycle<" << type.qualified_type_name << ">(type);\n";
+        emitted_types.back().size = "sizeof(" + type.qualified_type_name + ")";
     } else {
         output << "\n            type.size = 0;\n";
     }
 
+    emitted_types.back().underlying = type.underlying_name;
+
     if (type.kind == CXType_ConstantArray) {
         output <<
             "            type.underlying = type_of<" << type.underlying_name << ">();\n"
             "            type.length = " << type.array_length << ";\n";
+
+        emitted_types.back().length = type.array_length;
     } else if (type.kind == CXType_Pointer ||
                type.kind == CXType_LValueReference ||
                type.kind == CXType_RValueReference) {
@@ -933,10 +2102,13 @@ void emit_primitive(std::ostream& output, const Primitive& type) {
 
         if (type.kind == CXType_Pointer) {
             output << "            type.indirect_type = IndirectType::Pointer;\n";
+            emitted_types.back().subtype = "(uint8_t)IndirectType::Pointer";
         } else if (type.kind == CXType_LValueReference) {
             output << "            type.indirect_type = IndirectType::LReference;\n";
+            emitted_types.back().subtype = "(uint8_t)IndirectType::LReference";
         } else if (type.kind == CXType_RValueReference) {
             output << "            type.indirect_type = IndirectType::RReference;\n";
+            emitted_types.back().subtype = "(uint8_t)IndirectType::RReference";
         }
     }
 
@@ -948,23 +2120,21 @@ int emit_dependent_types(std::ostream& output) {
     int emitted = 0;
     // Emit primitives that are based on types from this translation unit
     // e.g. Foo* is a primitive type (pointer), but it's based on Foo (this translation unit)
-    std::vector<std::string> to_erase;
-    for (auto& type : primitives_to_emit) {
-        if (type.second.deepest == nullptr) continue;
+    // They're sorted so Foo* comes before Foo**
+    std::sort(pending_dependent_types.begin(), pending_dependent_types.end());
 
-        if (type.second.deepest->kind < CXType_FirstBuiltin ||
-            type.second.deepest->kind > CXType_LastBuiltin) {
-            emit_primitive(output, type.second);
+    for (auto& key : pending_dependent_types) {
+        auto it = primitives_to_emit.find(key);
+        if (it == primitives_to_emit.end()) continue;
 
-            emitted += 1;
-            to_erase.push_back(type.first);
-        }
-    }
+        emit_primitive(output, it->second);
+        emitted += 1;
 
-    for (auto& key : to_erase) {
-        primitives_to_emit.erase(key);
+        primitives_to_emit.erase(it);
+        emitted_primitives.insert(key);
     }
 
+    pending_dependent_types.clear();
     return emitted;
 }
 
@@ -975,12 +2145,18 @@ bool add_primitive_type(CXType type) {
         type.kind == CXType_LValueReference ||
         type.kind == CXType_RValueReference;
 
-    ClangStr name = clang_getTypeSpelling(type);
+    const std::string& name = get_type_spelling(type);
 
-    if (is_primitive && primitives_to_emit.find(name.c_str()) == primitives_to_emit.end()) {
+    if (is_primitive && primitives_to_emit.find(name.c_str()) == primitives_to_emit.end() &&
+        emitted_primitives.find(name.c_str()) == emitted_primitives.end()) {
         Primitive p;
         create_primitive(type, p);
 
+        if (p.deepest != nullptr &&
+            (p.deepest->kind < CXType_FirstBuiltin || p.deepest->kind > CXType_LastBuiltin)) {
+            pending_dependent_types.push_back(name.c_str());
+        }
+
         primitives_to_emit[name.c_str()] = p;
         return true;
     }
@@ -4,14 +4,33 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <cstdint>
 
 #include <clang-c/Index.h>
 
+struct CacheStats {
+    const char* name;
+    uint64_t hits;
+    uint64_t misses;
+};
+
 // Emits all marked children of this cursor
 int emit_eligable_children(std::ostream& output, CXCursor cursor);
 
+// Returns false if an annotated declaration of this cursor has errors or couldn't be laid out,
+// used to check whether a parse without includes is good enough
+bool validate_annotated_children(CXCursor cursor);
+
+// Where the common primitives came from
+enum class PrimitiveSource {
+    Table,
+    Cache,
+    Parse
+};
+
 // Adds all the common primitives, e.g. int8_t, int16_t, uint64_t, float, etc...
-void add_common_primitives(const std::vector<std::string>& clang_args);
+// They're only parsed if `clang_args` could change them and they're not in the cache at `cache_path`
+PrimitiveSource add_common_primitives(const std::vector<std::string>& clang_args, const std::string& cache_path);
 
 // Emits the includes, namespace and more
 // `is_core_file` should only be true if this is "type_titan.h" 
@@ -20,3 +39,21 @@ void emit_common_file_start(std::ostream& output, const char* type_titan_inc, co
 
 // Emits all primitives
 void emit_all_primitives(std::ostream& output);
+
+// Emits the table of all generated types and `warm_up_all()`
+void emit_warm_up(std::ostream& output);
+
+// Emits the hot/cold compact tables of all generated types
+void emit_compact_tables(std::ostream& output);
+
+// Emits the inheritance numbering and ancestors of all generated types
+void emit_hierarchy_tables(std::ostream& output);
+
+// Emits `add_all_dynamic_types()`, which fills the vtable lookup of `type_of_dynamic`
+void emit_dynamic_types(std::ostream& output);
+
+// Emits a single table of all generated types that refer to each other by type index
+void emit_type_table(std::ostream& output);
+
+// Returns the hit/miss counts of the type caches, accumulated over all translation units
+std::vector<CacheStats> get_cache_stats();
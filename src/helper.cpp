@@ -2,10 +2,19 @@
 
 #include <sstream>
 #include <cstring>
+#include <algorithm>
+#include <iterator>
 
 #if defined(_WIN32)
 #define WIN32_LEAN_AND_MEAN
 #include <Windows.h>
+#include <Psapi.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #endif
 
 class Index {
@@ -26,11 +35,11 @@ private:
     CXIndex index;
 };
 
-CXTranslationUnit parse_translation_unit(const char* contents, const char* filename,
+CXTranslationUnit parse_translation_unit(const char* contents, size_t length, const char* filename,
                                          const std::vector<std::string>& clang_args, unsigned int flags) {
     CXUnsavedFile unsaved_file;
     unsaved_file.Contents = contents;
-    unsaved_file.Length = (unsigned long)strlen(contents);
+    unsaved_file.Length = (unsigned long)length;
     unsaved_file.Filename = filename;
 
     std::vector<const char*> c_args;
@@ -42,7 +51,7 @@ CXTranslationUnit parse_translation_unit(const char* contents, const char* filen
     static Index index;
     CXTranslationUnit unit;
     CXErrorCode error = clang_parseTranslationUnit2(index.get_index(), filename, c_args.data(), (int)c_args.size(),
-                                                    &unsaved_file, 1, flags, &unit);
+                                                    &unsaved_file, contents ? 1 : 0, flags, &unit);
 
     if (error != CXError_Success) {
         std::string error_string;
@@ -91,6 +100,239 @@ bool get_args(CXCursor cursor, std::vector<std::string>& args) {
     }
 }
 
+#if defined(_WIN32)
+MappedFile::MappedFile(const char* path) {
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        return;
+    }
+
+    LARGE_INTEGER file_size;
+    if (!GetFileSizeEx(file, &file_size)) return;
+
+    opened = true;
+
+    // Empty files can't be mapped
+    if (file_size.QuadPart == 0) return;
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        opened = false;
+        return;
+    }
+
+    const char* view = (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        opened = false;
+        return;
+    }
+
+    contents = view;
+    length = (size_t)file_size.QuadPart;
+}
+
+MappedFile::~MappedFile() {
+    if (length > 0) UnmapViewOfFile(contents);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+}
+#else
+MappedFile::MappedFile(const char* path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return;
+    }
+
+    opened = true;
+
+    // Empty files can't be mapped
+    if (st.st_size > 0) {
+        void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (view == MAP_FAILED) {
+            opened = false;
+        } else {
+            contents = (const char*)view;
+            length = (size_t)st.st_size;
+        }
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (length > 0) munmap((void*)contents, length);
+}
+#endif
+
+bool has_annotations(const char* contents, size_t length) {
+    // `memchr` is vectorized in every common C library (SSE2/AVX2/NEON), and `!` is rare enough in headers that
+    // checking the two characters in front of every match is cheap. A hand-written SSE2 scan that matches the whole
+    // pattern at once does three compares per byte and ended up about 3x slower than this, which is already far
+    // faster than reading the file in the first place
+    const char* end = contents + length;
+    const char* at = contents + 2;
+
+    while (at < end) {
+        at = (const char*)memchr(at, '!', end - at);
+        if (!at) return false;
+
+        // Covers `//!!`, `///!`, `/*!!` and `/**!`, false positives only cost us a parse
+        if ((at[-2] == '/' || at[-2] == '*') && (at[-1] == '/' || at[-1] == '*')) return true;
+
+        at += 1;
+    }
+
+    return false;
+}
+
+// Skips a comment or literal starting at `at` if there is one
+static size_t skip_comment_or_literal(const char* contents, size_t length, size_t at) {
+    if (contents[at] == '/' && at + 1 < length) {
+        if (contents[at + 1] == '/') {
+            const char* end = (const char*)memchr(contents + at, '\n', length - at);
+            return end ? (size_t)(end - contents) : length;
+        }
+
+        if (contents[at + 1] == '*') {
+            for (size_t i = at + 2; i + 1 < length; i++) {
+                if (contents[i] == '*' && contents[i + 1] == '/') return i + 2;
+            }
+
+            return length;
+        }
+    }
+
+    if (contents[at] == '"' || contents[at] == '\'') {
+        char quote = contents[at];
+
+        for (size_t i = at + 1; i < length; i++) {
+            if (contents[i] == '\\') {
+                i += 1;
+            } else if (contents[i] == quote || contents[i] == '\n') {
+                return i + 1;
+            }
+        }
+
+        return length;
+    }
+
+    return at;
+}
+
+AnnotationIndex::AnnotationIndex(const char* contents, size_t length) {
+    size_t at = 0;
+
+    while (at < length) {
+        size_t end = skip_comment_or_literal(contents, length, at);
+
+        if (end == at) {
+            at += 1;
+            continue;
+        }
+
+        // Only doc comments (`//!`, `///`, `/*!`, `/**`) can be annotations, and an annotation's
+        // brief text starts with `!`, so those without one can be ignored
+        bool is_comment = contents[at] == '/';
+        bool is_doc = is_comment && at + 2 < end && (contents[at + 2] == '!' || contents[at + 2] == contents[at + 1]);
+
+        if (is_doc && memchr(contents + at + 3, '!', end - at - 3)) {
+            size_t window_end = end;
+
+            while (window_end < length) {
+                char c = contents[window_end];
+                if (c == ';' || c == '{' || c == '}') break;
+
+                size_t skipped = skip_comment_or_literal(contents, length, window_end);
+                window_end = (skipped == window_end) ? window_end + 1 : skipped;
+            }
+
+            windows.push_back(std::make_pair((unsigned)at, (unsigned)window_end));
+        }
+
+        at = end;
+    }
+}
+
+bool AnnotationIndex::is_candidate(unsigned offset) const {
+    // Find the last comment that starts before `offset`
+    auto it = std::upper_bound(windows.begin(), windows.end(), offset, [](unsigned offset, const std::pair<unsigned, unsigned>& window) {
+        return offset < window.first;
+    });
+
+    if (it == windows.begin()) return false;
+
+    return offset <= std::prev(it)->second;
+}
+
+bool AnnotationIndex::has_annotations_in(unsigned start, unsigned end) const {
+    auto it = std::lower_bound(windows.begin(), windows.end(), start, [](const std::pair<unsigned, unsigned>& window, unsigned start) {
+        return window.first < start;
+    });
+
+    return it != windows.end() && it->first < end;
+}
+
+size_t get_peak_memory() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return 0;
+
+    return (size_t)counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+
+#if defined(__APPLE__)
+    return (size_t)usage.ru_maxrss;
+#else
+    // Linux reports kilobytes
+    return (size_t)usage.ru_maxrss * 1024;
+#endif
+#endif
+}
+
+static double phase_seconds[(int)Phase::Count] = {};
+
+PhaseTimer::~PhaseTimer() {
+    auto end = std::chrono::high_resolution_clock::now();
+    phase_seconds[(int)phase] += std::chrono::duration<double>(end - start).count();
+}
+
+double get_phase_seconds(Phase phase) {
+    return phase_seconds[(int)phase];
+}
+
+const char* get_phase_name(Phase phase) {
+    switch (phase) {
+        case Phase::Scan:
+            return "scan";
+
+        case Phase::Read:
+            return "read";
+
+        case Phase::Parse:
+            return "parse";
+
+        case Phase::Emit:
+            return "emit";
+
+        case Phase::Core:
+            return "core";
+
+        case Phase::Count:
+            break;
+    }
+
+    return "";
+}
+
 std::string draw_symbol(char symbol, Color color) {
 #if defined(_WIN32)
     SetConsoleTextAttribute(GetStdHandle(STD_OUTPUT_HANDLE), (WORD)color);
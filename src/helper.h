@@ -3,6 +3,7 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <chrono>
 
 #include <clang-c/Index.h>
 
@@ -40,9 +41,94 @@ static const int DEFAULT_ARGS_COUNT = sizeof(DEFAULT_ARGS) / sizeof(*DEFAULT_ARG
 
 const unsigned int DEFAULT_FLAGS = CXTranslationUnit_SkipFunctionBodies | CXTranslationUnit_Incomplete;
 
-CXTranslationUnit parse_translation_unit(const char* contents, const char* filename,
+// Parses `contents` as `filename`, if `contents` is null the file is read from disk by clang itself
+CXTranslationUnit parse_translation_unit(const char* contents, size_t length, const char* filename,
                                          const std::vector<std::string>& clang_args, unsigned int flags = DEFAULT_FLAGS);
 
 bool get_args(CXCursor cursor, std::vector<std::string>& args);
 
+// A read-only view of a whole file, the file is memory-mapped if possible
+class MappedFile {
+public:
+    MappedFile(const char* path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const {
+        return opened;
+    }
+
+    // Not null-terminated
+    const char* data() const {
+        return contents;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+private:
+    bool opened = false;
+    const char* contents = "";
+    size_t length = 0;
+
+#if defined(_WIN32)
+    void* file = nullptr;
+    void* mapping = nullptr;
+#endif
+};
+
+// Returns true if `contents` has anything that looks like an annotation comment (`//!!`, `/*!!`, etc.),
+// files without one have nothing to index so they don't have to be parsed
+bool has_annotations(const char* contents, size_t length);
+
+// The places in a file where annotated declarations can start, built with a single pass over the source
+// so the cursor walk only has to ask clang for the comments of declarations that could be annotated.
+// Every annotation comment gets a window from the start of the comment up to the first `;`, `{` or `}`
+// after it, which is where the declaration it's attached to has to start.
+class AnnotationIndex {
+public:
+    AnnotationIndex(const char* contents, size_t length);
+
+    // Returns true if a declaration starting at `offset` might be annotated
+    bool is_candidate(unsigned offset) const;
+
+    // Returns true if there are any annotation comments in [start, end)
+    bool has_annotations_in(unsigned start, unsigned end) const;
+
+private:
+    // Sorted by the start of the comment
+    std::vector<std::pair<unsigned, unsigned>> windows;
+};
+
+// The peak resident memory of the process in bytes, 0 if unknown
+size_t get_peak_memory();
+
+// The phases of a run, the time spent in each phase is printed with `-profile`
+enum class Phase {
+    Scan,
+    Read,
+    Parse,
+    Emit,
+    Core,
+    Count
+};
+
+// Adds the time between construction and destruction to `phase`
+class PhaseTimer {
+public:
+    PhaseTimer(Phase phase) : phase(phase), start(std::chrono::high_resolution_clock::now()) {}
+    ~PhaseTimer();
+
+private:
+    Phase phase;
+    std::chrono::high_resolution_clock::time_point start;
+};
+
+double get_phase_seconds(Phase phase);
+
+const char* get_phase_name(Phase phase);
+
 std::string draw_symbol(char symbol, Color color);
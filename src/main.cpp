@@ -3,6 +3,7 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <unordered_set>
 #include <chrono>
 #include <filesystem>
 
@@ -10,6 +11,7 @@
 
 #include "helper.h"
 #include "emitter.h"
+#include "scanner.h"
 #include "source_code.h"
 
 namespace fs = std::filesystem;
@@ -19,6 +21,9 @@ static const char* DEFAULT_NAMESPACE = "tt";
 static const bool DEFAULT_NO_EXTRAS = false;
 static const bool DEFAULT_NO_EMPTY = false;
 static const bool DEFAULT_NO_RECURSIVE = false;
+static const bool DEFAULT_TYPE_TABLE = false;
+static const bool DEFAULT_PROFILE = false;
+static const bool DEFAULT_FAST_PARSE = false;
 
 void print_help(int argc, char** argv);
 
@@ -32,10 +37,20 @@ int main(int argc, char** argv) {
     bool gen_extras = !DEFAULT_NO_EXTRAS;
     bool del_empty = DEFAULT_NO_EMPTY;
     bool do_recurse = !DEFAULT_NO_RECURSIVE;
+    bool gen_table = DEFAULT_TYPE_TABLE;
+    bool profile = DEFAULT_PROFILE;
+    bool fast_parse = DEFAULT_FAST_PARSE;
     std::string custom_include;
 
     fs::path output_dir;
     std::vector<std::string> files;
+
+    // Wildcards are expanded after all arguments are parsed so they can share a single directory walk,
+    // `inputs` keeps the order of the arguments with -1 for plain files
+    std::vector<std::pair<std::string, int>> inputs;
+    std::vector<ScanPattern> patterns;
+    ScanOptions scan_options;
+    std::string primitive_cache;
     std::vector<std::string> clang_args;
 
     for (int i = 1; i < argc; i++) {
@@ -87,7 +102,7 @@ int main(int argc, char** argv) {
             }
 
             if (arg == "-no-empty") {
-                del_empty = false;
+                del_empty = true;
                 continue;
             }
 
@@ -96,6 +111,54 @@ int main(int argc, char** argv) {
                 continue;
             }
 
+            if (arg == "-type-table") {
+                gen_table = true;
+                continue;
+            }
+
+            if (arg == "-fast-parse") {
+                fast_parse = true;
+                continue;
+            }
+
+            if (arg == "-profile") {
+                profile = true;
+                continue;
+            }
+
+            if (arg == "-ignore") {
+                if (i + 1 >= argc) {
+                    std::cout << "[" << draw_symbol('!', Color::Red) << "] no argument provided for option '-ignore'\n";
+                    return 6;
+                }
+
+                scan_options.ignore.push_back(argv[i + 1]);
+                i += 1;
+                continue;
+            }
+
+            if (arg == "-scan-cache") {
+                if (i + 1 >= argc) {
+                    std::cout << "[" << draw_symbol('!', Color::Red) << "] no argument provided for option '-scan-cache'\n";
+                    return 7;
+                }
+
+                scan_options.cache_path = argv[i + 1];
+                i += 1;
+                continue;
+            }
+
+            if (arg == "-primitive-cache") {
+                if (i + 1 >= argc) {
+                    std::cout << "[" << draw_symbol('!', Color::Red) << "] no argument provided for option '-primitive-cache'\n";
+                    return 8;
+                }
+
+                primitive_cache = argv[i + 1];
+                i += 1;
+                continue;
+            }
+
             if (arg == "-custom-inc") {
                 if (i + 1 >= argc) {
                     std::cout << "[" << draw_symbol('!', Color::Red) << "] no argument provided for options '-custom-inc'\n";
@@ -133,33 +196,43 @@ int main(int argc, char** argv) {
                 continue;
             }
 
-            auto do_search = [&](auto iterator) {
-                for (auto& entry : iterator) {
-                    if (entry.is_regular_file() && entry.path().extension() == search_path.extension()) {
-                        std::string p = entry.path().filename().generic_string();
-                        // Don't add any type_titan.*.h or *.tt.h files
-                        bool is_type_titan = p.rfind("type_titan.", 0) == 0;
-                        bool is_tt = p.rfind("tt.h", p.size() - 4) == p.size() - 4;
-                        if (!is_type_titan && !is_tt) {
-                            files.push_back(entry.path().generic_string());
-                        }
-                    }
-                }
-            };
+            ScanPattern pattern;
+            pattern.directory = search_path.parent_path();
+            pattern.extension = search_path.extension();
+            pattern.recursive = do_recurse;
 
-            try {
-                if (do_recurse) {
-                    do_search(fs::recursive_directory_iterator(search_path.parent_path()));
-                } else {
-                    do_search(fs::directory_iterator(search_path.parent_path()));
+            inputs.push_back(std::make_pair(arg, (int)patterns.size()));
+            patterns.push_back(pattern);
+        } else {
+            inputs.push_back(std::make_pair(arg, -1));
+        }
+    }
+
+    {
+        PhaseTimer timer(Phase::Scan);
+        std::vector<std::vector<std::string>> matches;
+
+        if (!scan_directories(patterns, scan_options, matches)) {
+            std::cout << "[" << draw_symbol('!', Color::Red) << "] failed to (recursively) search directories\n";
+            return 4;
+        }
+
+        // Overlapping wildcards match the same files, only parse those once
+        std::unordered_set<std::string> seen;
+        auto add_file = [&](const std::string& file) {
+            if (seen.insert(file).second) {
+                files.push_back(file);
+            }
+        };
+
+        for (auto& input : inputs) {
+            if (input.second < 0) {
+                add_file(input.first);
+            } else {
+                for (auto& file : matches[input.second]) {
+                    add_file(file);
                 }
-            } catch (...) {
-                std::cout << "[" << draw_symbol('!', Color::Red) << "] failed to (recursively) search directories\n";
-                return 4;
             }
-
-        } else {
-            files.push_back(arg);
         }
     }
 
@@ -172,7 +245,7 @@ int main(int argc, char** argv) {
         }
     }
 
-    for (int i = 0; i < clang_args.size(); i++) {
+    for (size_t i = 0; i < clang_args.size(); i++) {
         clang_args_line += clang_args[i];
         if (i + 1 < clang_args.size()) {
             clang_args_line += ", ";
@@ -184,6 +257,8 @@ int main(int argc, char** argv) {
         "[" << draw_symbol('?', Color::Blue) << "] namespace        : " << namespace_name << "\n"
         "[" << draw_symbol('?', Color::Blue) << "] generate extras  : " << gen_extras << "\n"
         "[" << draw_symbol('?', Color::Blue) << "] delete empty     : " << del_empty << "\n"
+        "[" << draw_symbol('?', Color::Blue) << "] type table       : " << gen_table << "\n"
+        "[" << draw_symbol('?', Color::Blue) << "] fast parse       : " << fast_parse << "\n"
         "[" << draw_symbol('?', Color::Blue) << "] clang arguments  : " << clang_args_line << "\n\n";
 
     auto start_time = chrono::high_resolution_clock::now();
@@ -202,29 +277,91 @@ int main(int argc, char** argv) {
             "#include \"type_titan.h\"";
     }
 
-    add_common_primitives(clang_args);
+    PrimitiveSource primitive_source;
+
+    {
+        PhaseTimer timer(Phase::Parse);
+        primitive_source = add_common_primitives(clang_args, primitive_cache);
+    }
 
     if (files.empty()) {
         std::cout << "[" << draw_symbol('*', Color::Green) << "] no files specified, only generating core files\n";
     }
 
+    int skipped = 0;
+    int fast_parsed = 0;
+
     for (auto& file : files) {
         fs::path new_path = fs::path(file, fs::path::generic_format);
 
         new_path.replace_extension("tt" + new_path.extension().generic_string());
 
-        std::ifstream in(file);
+        std::string tt_path;
+        if (custom_include.empty()) {
+            fs::path tt_file = output_dir / "type_titan.h";
+            fs::path path = fs::relative(tt_file, new_path.parent_path());
 
-        if (!in.is_open()) {
-            std::cout << "[" << draw_symbol('!', Color::Red) << "] could not open file '" << file << "'\n";
-            continue;
+            tt_path = path.generic_string();
+            tt_path = '"' + tt_path + '"';
+        } else {
+            tt_path = custom_include;
         }
 
-        std::ostringstream sstr;
-        sstr << in.rdbuf();
+        std::string filename = fs::path(file).filename().generic_string();
+
+        {
+            PhaseTimer timer(Phase::Read);
+            MappedFile in(file.c_str());
+
+            if (!in.is_open()) {
+                std::cout << "[" << draw_symbol('!', Color::Red) << "] could not open file '" << file << "'\n";
+                continue;
+            }
+
+            // Without annotations there's nothing to index, so we produce the same output as a file
+            // with 0 exported types without parsing it
+            if (!has_annotations(in.data(), in.size())) {
+                skipped += 1;
+
+                if (del_empty) {
+                    fs::remove(new_path);
+                } else {
+                    std::ofstream out(new_path);
+                    emit_common_file_start(out, tt_path.c_str(), filename.c_str(), namespace_name.c_str(), false);
+                    out << "\n}\n";
+                }
+
+                continue;
+            }
+        }
 
         std::cout << "[" << draw_symbol('*', Color::Green) << "] parsing '" << file << "'\n";
-        CXTranslationUnit unit = parse_translation_unit(sstr.str().c_str(), file.c_str(), clang_args);
+        CXTranslationUnit unit = nullptr;
+
+        {
+            PhaseTimer timer(Phase::Parse);
+
+            // Try without following any includes first, that's only good enough if the annotated
+            // declarations don't use anything from them
+            if (fast_parse) {
+                unit = parse_translation_unit(nullptr, 0, file.c_str(), clang_args,
+                                              DEFAULT_FLAGS | CXTranslationUnit_SingleFileParse);
+
+                if (unit && validate_annotated_children(clang_getTranslationUnitCursor(unit))) {
+                    fast_parsed += 1;
+                } else if (unit) {
+                    std::cout << "[" << draw_symbol('/', Color::Yellow) << "] reparsing '" << file << "' with includes\n";
+
+                    clang_disposeTranslationUnit(unit);
+                    unit = nullptr;
+                }
+            }
+
+            // The file is on disk already, so let clang read it itself instead of copying it into an unsaved file
+            if (!unit) {
+                unit = parse_translation_unit(nullptr, 0, file.c_str(), clang_args);
+            }
+        }
 
         if (!unit) {
             continue;
@@ -238,19 +375,8 @@ int main(int argc, char** argv) {
             continue;
         }
 
+        PhaseTimer timer(Phase::Emit);
 
-        std::string tt_path;
-        if (custom_include.empty()) {
-            fs::path tt_file = output_dir / "type_titan.h";
-            fs::path path = fs::relative(tt_file, new_path.parent_path());
-
-            tt_path = path.generic_string();
-            tt_path = '"' + tt_path + '"';
-        } else {
-            tt_path = custom_include;
-        }
-
-        std::string filename = fs::path(file).filename().generic_string();
         emit_common_file_start(out, tt_path.c_str(), filename.c_str(), namespace_name.c_str(), false);
         int emitted = emit_eligable_children(out, clang_getTranslationUnitCursor(unit));
         out << "\n}\n";
@@ -264,9 +390,21 @@ int main(int argc, char** argv) {
         }
     }
 
+    if (fast_parse) {
+        std::cout <<
+            "[" << draw_symbol('/', Color::Yellow) << "] " << fast_parsed << " of " << files.size() - skipped <<
+            " files were parsed without includes\n";
+    }
+
+    if (skipped > 0) {
+        std::cout << "[" << draw_symbol('/', Color::Yellow) << "] skipped " << skipped << " files without annotations\n";
+    }
+
     // Generate core file
     // If we have custom include specified then the core files are in a custom location already
     if (custom_include.empty()) {
+        PhaseTimer timer(Phase::Core);
+
         std::cout << "[" << draw_symbol('*', Color::Green) << "] generating 'type_titan.h'\n";
 
         fs::path core_path = output_dir;
@@ -291,6 +429,7 @@ int main(int argc, char** argv) {
             out <<
                 "// This file was generated by TypeTitan\n"
                 "#pragma once\n"
+                "#include <chrono>\n"
                 "#include \"type_titan.h\"\n\n";
 
             for (auto& file : files) {
@@ -304,6 +443,10 @@ int main(int argc, char** argv) {
                 }
             }
 
+            out << "\nnamespace " << namespace_name << " {\n" << warm_up_h;
+            emit_warm_up(out);
+            out << "\n}\n";
+
             out.close();
 
             // Utilities
@@ -316,12 +459,75 @@ int main(int argc, char** argv) {
             out <<
                 "// This file was generated by TypeTitan\n"
                 "#pragma once\n"
+                "#include <stdlib.h>\n"
+                "#include <cstddef>\n"
                 "#include \"type_titan.h\"\n\n"
 
+                "#if defined(__AVX2__)\n"
+                "#include <immintrin.h>\n"
+                "#endif\n\n"
+
                 "namespace " << namespace_name << " {\n" <<
                 utils_h <<
+                gather_h <<
+                soa_h <<
+                clone_h <<
+                delta_h <<
+                any_h <<
                 "\n}\n";
             out.close();
+
+            // Compact tables
+            std::cout << "[" << draw_symbol('*', Color::Green) << "] generating 'type_titan.compact.h'\n";
+
+            fs::path compact_path = output_dir;
+            compact_path.replace_filename("type_titan.compact.h");
+            out.open(compact_path);
+
+            out <<
+                "// This file was generated by TypeTitan\n"
+                "#pragma once\n"
+                "#include <string.h>\n"
+                "#include <new>\n"
+                "#include \"type_titan.inc.h\"\n\n"
+
+                "namespace " << namespace_name << " {\n" <<
+                compact_h << "\n";
+
+            emit_compact_tables(out);
+            emit_hierarchy_tables(out);
+
+            out << compact_functions_h << dynamic_h << "\n";
+
+            emit_dynamic_types(out);
+
+            out << dynamic_functions_h << "\n}\n";
+            out.close();
+
+            if (gen_table) {
+                // Type table
+                std::cout << "[" << draw_symbol('*', Color::Green) << "] generating 'type_titan.table.h'\n";
+
+                fs::path table_path = output_dir;
+                table_path.replace_filename("type_titan.table.h");
+                out.open(table_path);
+
+                out <<
+                    "// This file was generated by TypeTitan\n"
+                    "#pragma once\n"
+                    "#include \"type_titan.inc.h\"\n"
+                    "#include \"type_titan.util.h\"\n\n"
+
+                    "namespace " << namespace_name << " {\n" <<
+                    table_h << "\n";
+
+                emit_type_table(out);
+
+                out << table_functions_h << "\n}\n";
+                out.close();
+            }
+        } else if (gen_table) {
+            std::cout << "[" << draw_symbol('/', Color::Yellow) << "] '-type-table' has no effect with '-no-extras'\n";
         }
     }
 
@@ -330,7 +536,37 @@ int main(int argc, char** argv) {
 
     std::cout <<
         "\n[" << draw_symbol('~', Color::Cyan) << "] parsed " <<
-        files.size() << " files in " << (double)duration.count() / 1000.0 << " seconds\n";
+        files.size() - skipped << " files in " << (double)duration.count() / 1000.0 << " seconds\n";
+
+    if (profile) {
+        for (int i = 0; i < (int)Phase::Count; i++) {
+            std::cout <<
+                "[" << draw_symbol('~', Color::Cyan) << "] phase " << get_phase_name((Phase)i) << ": " <<
+                get_phase_seconds((Phase)i) << " seconds\n";
+        }
+
+        std::cout <<
+            "[" << draw_symbol('~', Color::Cyan) << "] peak memory: " <<
+            (double)get_peak_memory() / (1024.0 * 1024.0) << " MiB\n";
+
+        static const char* PRIMITIVE_SOURCES[] = { "built-in table", "cache", "parsed" };
+        std::cout <<
+            "[" << draw_symbol('~', Color::Cyan) << "] primitives: " << PRIMITIVE_SOURCES[(int)primitive_source] << "\n";
+
+        ScanStats scan_stats = get_scan_stats();
+        std::cout <<
+            "[" << draw_symbol('~', Color::Cyan) << "] scan: " << scan_stats.listed << " directories listed, " <<
+            scan_stats.cached << " from cache\n";
+
+        for (auto& stats : get_cache_stats()) {
+            uint64_t total = stats.hits + stats.misses;
+            double hit_rate = (total > 0) ? (double)stats.hits * 100.0 / (double)total : 0.0;
+
+            std::cout <<
+                "[" << draw_symbol('~', Color::Cyan) << "] cache " << stats.name << ": " <<
+                stats.hits << " hits, " << stats.misses << " misses (" << hit_rate << "%)\n";
+        }
+    }
 
     return 0;
 }
@@ -372,6 +608,9 @@ void print_help(int argc, char** argv) {
         "    -no-empty       : deletes any files with 0 exported types\n"
         "                    : default: " << DEFAULT_NO_EMPTY << "\n"
         "                    :\n"
+        "    -primitive-cache: caches the common primitives in this file if the clang arguments\n"
+        "                    : can change them, otherwise they're taken from a built-in table\n"
+        "                    :\n"
         "    -custom-inc     : specifies a custom include path to type_titan.h\n"
         "                    : if this option is specified TypeTitan won't generate any\n"
         "                    : core files, useful if the core files are in an external library/project\n"
@@ -380,6 +619,25 @@ void print_help(int argc, char** argv) {
         "    -no-recursive   : disables recursive search on wildcard entries\n"
         "                    : default: " << DEFAULT_NO_RECURSIVE << "\n"
         "                    :\n"
+        "    -ignore         : skips files and directories with this name when expanding wildcards,\n"
+        "                    : `*` and `?` are supported and it can be specified multiple times\n"
+        "                    : example: -ignore build -ignore *_generated.h\n"
+        "                    :\n"
+        "    -scan-cache     : caches the directory listings of wildcard entries in this file\n"
+        "                    : and only lists directories again if they were modified\n"
+        "                    :\n"
+        "    -fast-parse     : parses files without following their includes first and only parses\n"
+        "                    : them again with includes if an annotated declaration needs them\n"
+        "                    : default: " << DEFAULT_FAST_PARSE << "\n"
+        "                    :\n"
+        "    -profile        : prints the time spent in each phase, the peak memory and the cache hit rates\n"
+        "                    : after generating\n"
+        "                    : default: " << DEFAULT_PROFILE << "\n"
+        "                    :\n"
+        "    -type-table     : generates type_titan.table.h, a single table of all types that\n"
+        "                    : refer to each other by index instead of by pointer\n"
+        "                    : default: " << DEFAULT_TYPE_TABLE << "\n"
+        "                    :\n"
         "    -clang          : passes all subsequent commands to the clang parser\n"
         "                    : default: " << default_commands << "\n"
         "                    :\n";
@@ -0,0 +1,337 @@
+#include "scanner.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+namespace fs = std::filesystem;
+
+static const char* CACHE_HEADER = "TypeTitan scan cache 1";
+static const unsigned MAX_SCAN_THREADS = 16;
+
+// The entries of a single directory, unfiltered so the cache doesn't depend on the ignore list
+struct Listing {
+    int64_t mtime = 0;
+    std::vector<std::string> files;
+    std::vector<std::string> directories;
+};
+
+typedef std::unordered_map<std::string, Listing> ListingMap;
+
+static ScanStats scan_stats = {};
+
+// Every directory is listed at most once per run, no matter how many patterns or roots share it
+struct Walk {
+    const ScanOptions* options = nullptr;
+    const ListingMap* cache = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable cv;
+
+    // Directories waiting to be listed and whether their subdirectories should be walked too
+    std::vector<std::pair<std::string, bool>> queue;
+    std::unordered_map<std::string, bool> queued;
+    int active = 0;
+    bool failed = false;
+
+    ListingMap listings;
+};
+
+static bool matches_glob(const char* pattern, const char* name) {
+    while (*pattern) {
+        if (*pattern == '*') {
+            // Collapse consecutive stars and try every possible split
+            while (*pattern == '*') pattern += 1;
+            if (!*pattern) return true;
+
+            for (; *name; name++) {
+                if (matches_glob(pattern, name)) return true;
+            }
+
+            return false;
+        }
+
+        if (!*name || (*pattern != '?' && *pattern != *name)) return false;
+
+        pattern += 1;
+        name += 1;
+    }
+
+    return !*name;
+}
+
+static bool is_ignored(const ScanOptions& options, const std::string& name) {
+    for (auto& ignore : options.ignore) {
+        if (matches_glob(ignore.c_str(), name.c_str())) return true;
+    }
+
+    return false;
+}
+
+static std::string get_directory_key(const fs::path& directory) {
+    std::string key = directory.lexically_normal().generic_string();
+
+    if (key.empty()) return ".";
+    if (key.size() > 1 && key.back() == '/') key.pop_back();
+
+    return key;
+}
+
+static std::string get_child_key(const std::string& key, const std::string& name) {
+    if (key == ".") return name;
+    if (key.back() == '/') return key + name;
+
+    return key + '/' + name;
+}
+
+static bool read_listing(const std::string& directory, const ListingMap& cache, Listing& listing, bool& from_cache) {
+    std::error_code error;
+
+    fs::file_time_type time = fs::last_write_time(directory, error);
+    if (error) return false;
+
+    listing.mtime = (int64_t)time.time_since_epoch().count();
+
+    // A directory's modification time changes whenever an entry is added, removed or renamed
+    auto cached = cache.find(directory);
+    if (cached != cache.end() && cached->second.mtime == listing.mtime) {
+        listing = cached->second;
+        from_cache = true;
+        return true;
+    }
+
+    from_cache = false;
+
+    fs::directory_iterator iterator(directory, error);
+
+    for (; !error && iterator != fs::directory_iterator(); iterator.increment(error)) {
+        const fs::directory_entry& entry = *iterator;
+        std::string name = entry.path().filename().generic_string();
+
+        // Don't follow symlinked directories, the same as `recursive_directory_iterator`
+        std::error_code status_error;
+        if (entry.is_directory(status_error) && !entry.is_symlink(status_error)) {
+            listing.directories.push_back(name);
+        } else if (entry.is_regular_file(status_error)) {
+            listing.files.push_back(name);
+        }
+    }
+
+    if (error) return false;
+
+    std::sort(listing.files.begin(), listing.files.end());
+    std::sort(listing.directories.begin(), listing.directories.end());
+
+    return true;
+}
+
+// Expects the lock to be held
+static void queue_directory(Walk& walk, const std::string& directory, bool recursive) {
+    auto it = walk.queued.find(directory);
+
+    if (it != walk.queued.end() && (it->second || !recursive)) {
+        return;
+    }
+
+    walk.queued[directory] = recursive;
+    walk.queue.push_back(std::make_pair(directory, recursive));
+}
+
+static void walk_worker(Walk* walk) {
+    std::unique_lock<std::mutex> lock(walk->mutex);
+
+    while (true) {
+        walk->cv.wait(lock, [walk]() {
+            return !walk->queue.empty() || walk->active == 0;
+        });
+
+        if (walk->queue.empty()) {
+            break;
+        }
+
+        auto work = walk->queue.back();
+        walk->queue.pop_back();
+
+        // It might have been listed already if it was queued non-recursively first
+        auto listed = walk->listings.find(work.first);
+
+        if (listed == walk->listings.end()) {
+            walk->active += 1;
+            lock.unlock();
+
+            Listing listing;
+            bool from_cache = false;
+            bool success = read_listing(work.first, *walk->cache, listing, from_cache);
+
+            lock.lock();
+            walk->active -= 1;
+
+            if (!success) {
+                walk->failed = true;
+                walk->cv.notify_all();
+                continue;
+            }
+
+            if (from_cache) {
+                scan_stats.cached += 1;
+            } else {
+                scan_stats.listed += 1;
+            }
+
+            listed = walk->listings.emplace(work.first, std::move(listing)).first;
+        }
+
+        if (work.second) {
+            for (auto& name : listed->second.directories) {
+                if (!is_ignored(*walk->options, name)) {
+                    queue_directory(*walk, get_child_key(work.first, name), true);
+                }
+            }
+        }
+
+        walk->cv.notify_all();
+    }
+
+    walk->cv.notify_all();
+}
+
+static void collect_files(const ListingMap& listings, const std::string& key, const fs::path& path,
+                          const ScanPattern& pattern, const ScanOptions& options, std::vector<std::string>& files) {
+    auto it = listings.find(key);
+    if (it == listings.end()) return;
+
+    for (auto& name : it->second.files) {
+        fs::path file = name;
+
+        if (file.extension() != pattern.extension || is_ignored(options, name)) {
+            continue;
+        }
+
+        // Don't add any type_titan.*.h or *.tt.h files
+        bool is_type_titan = name.compare(0, 11, "type_titan.") == 0;
+        bool is_tt = file.stem().extension() == ".tt";
+
+        if (!is_type_titan && !is_tt) {
+            files.push_back((path / file).generic_string());
+        }
+    }
+
+    if (!pattern.recursive) return;
+
+    for (auto& name : it->second.directories) {
+        if (!is_ignored(options, name)) {
+            collect_files(listings, get_child_key(key, name), path / name, pattern, options, files);
+        }
+    }
+}
+
+static void load_cache(const std::string& path, ListingMap& cache) {
+    std::ifstream in(path);
+    if (!in.is_open()) return;
+
+    std::string line;
+    if (!std::getline(in, line) || line != CACHE_HEADER) return;
+
+    Listing* current = nullptr;
+
+    while (std::getline(in, line)) {
+        if (line.size() < 2) continue;
+
+        if (line[0] == 'D') {
+            // D <mtime> <directory>
+            size_t split = line.find(' ', 2);
+            if (split == std::string::npos) {
+                current = nullptr;
+                continue;
+            }
+
+            current = &cache[line.substr(split + 1)];
+            current->mtime = std::strtoll(line.c_str() + 2, nullptr, 10);
+            current->files.clear();
+            current->directories.clear();
+        } else if (current && line[0] == 'F') {
+            current->files.push_back(line.substr(2));
+        } else if (current && line[0] == 'S') {
+            current->directories.push_back(line.substr(2));
+        }
+    }
+}
+
+static void save_cache(const std::string& path, const ListingMap& cache) {
+    std::ofstream out(path);
+    if (!out.is_open()) return;
+
+    out << CACHE_HEADER << "\n";
+
+    for (auto& entry : cache) {
+        out << "D " << entry.second.mtime << " " << entry.first << "\n";
+
+        for (auto& name : entry.second.files) {
+            out << "F " << name << "\n";
+        }
+
+        for (auto& name : entry.second.directories) {
+            out << "S " << name << "\n";
+        }
+    }
+}
+
+bool scan_directories(const std::vector<ScanPattern>& patterns, const ScanOptions& options,
+                      std::vector<std::vector<std::string>>& results) {
+    results.clear();
+    results.resize(patterns.size());
+
+    if (patterns.empty()) return true;
+
+    ListingMap cache;
+    if (!options.cache_path.empty()) {
+        load_cache(options.cache_path, cache);
+    }
+
+    Walk walk;
+    walk.options = &options;
+    walk.cache = &cache;
+
+    for (auto& pattern : patterns) {
+        queue_directory(walk, get_directory_key(pattern.directory), pattern.recursive);
+    }
+
+    unsigned thread_count = std::min(std::max(std::thread::hardware_concurrency(), 1u), MAX_SCAN_THREADS);
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < thread_count; i++) {
+        threads.emplace_back(walk_worker, &walk);
+    }
+
+    walk_worker(&walk);
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    if (walk.failed) return false;
+
+    for (size_t i = 0; i < patterns.size(); i++) {
+        collect_files(walk.listings, get_directory_key(patterns[i].directory), patterns[i].directory,
+                      patterns[i], options, results[i]);
+    }
+
+    if (!options.cache_path.empty() && scan_stats.listed > 0) {
+        for (auto& entry : walk.listings) {
+            cache[entry.first] = entry.second;
+        }
+
+        save_cache(options.cache_path, cache);
+    }
+
+    return true;
+}
+
+ScanStats get_scan_stats() {
+    return scan_stats;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <filesystem>
+
+// A wildcard input like `src/*.h`
+struct ScanPattern {
+    std::filesystem::path directory;
+    std::filesystem::path extension;
+    bool recursive;
+};
+
+struct ScanOptions {
+    // File and directory names to skip, `*` and `?` are supported
+    std::vector<std::string> ignore;
+
+    // Where the directory listings are cached between runs, empty to disable
+    std::string cache_path;
+};
+
+struct ScanStats {
+    uint64_t listed;
+    uint64_t cached;
+};
+
+// Expands all patterns with a single walk over the directories they share,
+// `results[i]` receives the files matching `patterns[i]`.
+// Returns false if any of the directories could not be read.
+bool scan_directories(const std::vector<ScanPattern>& patterns, const ScanOptions& options,
+                      std::vector<std::vector<std::string>>& results);
+
+ScanStats get_scan_stats();
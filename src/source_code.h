@@ -52,7 +52,31 @@ static const char* definitions = R"STR(enum class TypeInfoType : uint8_t {
     Indirect,
     Record,
     Enum,
-    Function
+    Function,
+    Container
+};
+
+// What kind of primitive a type is, so primitives can be told apart with a switch instead of comparing type ids
+enum class PrimitiveKind : uint8_t {
+    None, // Not a primitive, e.g. records, enums and functions
+    Bool,
+    I8,
+    I16,
+    I32,
+    I64,
+    U8,
+    U16,
+    U32,
+    U64,
+    F32,
+    F64,
+    Char,
+    WChar,
+    Void,
+    Pointer,
+    Reference,
+    Array,
+    Other // e.g. long double, char16_t or std::nullptr_t
 };
 
 enum class RecordType : uint8_t {
@@ -81,11 +105,74 @@ enum class IndirectType : uint8_t {
 
 typedef uint64_t type_id_t;
 
+// Copies the field value out of/into `object`, `out`/`in` must be able to hold the field type
+typedef void (*field_getter_t)(const void* object, void* out);
+typedef void (*field_setter_t)(void* object, const void* in);
+
+// Gets the element count of/a pointer to the elements of/resizes a type-erased container
+typedef size_t (*container_size_t)(const void* container);
+typedef void* (*container_data_t)(void* container);
+typedef void (*container_resize_t)(void* container, size_t size);
+
+// Used for offsets that can't be determined at compile-time, e.g. virtual bases
+static const uint32_t UNKNOWN_OFFSET = 0xFFFFFFFF;
+
+// Used for types that aren't in the generated type table, e.g. templates
+static const uint32_t INVALID_TYPE_INDEX = 0xFFFFFFFF;
+
+template<typename T>
+constexpr PrimitiveKind get_primitive_kind_integer() {
+    return (sizeof(T) == 1) ? (std::is_signed<T>::value ? PrimitiveKind::I8 : PrimitiveKind::U8) :
+           (sizeof(T) == 2) ? (std::is_signed<T>::value ? PrimitiveKind::I16 : PrimitiveKind::U16) :
+           (sizeof(T) == 4) ? (std::is_signed<T>::value ? PrimitiveKind::I32 : PrimitiveKind::U32) :
+           (sizeof(T) == 8) ? (std::is_signed<T>::value ? PrimitiveKind::I64 : PrimitiveKind::U64) :
+           PrimitiveKind::Other;
+}
+
+// Evaluated by the compiler so `long` ends up as I32 or I64 depending on the platform
+template<typename T, typename U = typename std::remove_cv<T>::type>
+constexpr PrimitiveKind get_primitive_kind() {
+    return std::is_same<U, bool>::value ? PrimitiveKind::Bool :
+           std::is_same<U, char>::value ? PrimitiveKind::Char :
+           std::is_same<U, wchar_t>::value ? PrimitiveKind::WChar :
+           std::is_same<U, float>::value ? PrimitiveKind::F32 :
+           std::is_same<U, double>::value ? PrimitiveKind::F64 :
+           std::is_void<U>::value ? PrimitiveKind::Void :
+           std::is_pointer<U>::value ? PrimitiveKind::Pointer :
+           std::is_reference<U>::value ? PrimitiveKind::Reference :
+           std::is_array<U>::value ? PrimitiveKind::Array :
+           (std::is_integral<U>::value && !std::is_same<U, char16_t>::value && !std::is_same<U, char32_t>::value) ?
+               get_primitive_kind_integer<typename std::conditional<std::is_integral<U>::value, U, int>::type>() :
+           (std::is_arithmetic<U>::value || std::is_same<U, decltype(nullptr)>::value) ? PrimitiveKind::Other :
+           PrimitiveKind::None;
+}
+
+// Lifecycle operations on uninitialized memory (`object`) or a live object (`destroy`), nullptr if the type doesn't support them.
+// `move` leaves `other` alive, it still has to be destroyed
+struct TypeOps {
+    void (*construct)(void* object);
+    void (*copy)(void* object, const void* other);
+    void (*move)(void* object, void* other);
+    void (*destroy)(void* object);
+};
+
+// The `TypeInfo::traits` flags, they allow skipping the thunks: a trivially constructible type doesn't need
+// to be constructed, a trivially copyable type can be copied and moved with `memcpy` and a trivially
+// destructible type doesn't need to be destroyed
+static const uint8_t TYPE_TRIVIALLY_CONSTRUCTIBLE = 1 << 0;
+static const uint8_t TYPE_TRIVIALLY_COPYABLE = 1 << 1;
+static const uint8_t TYPE_TRIVIALLY_DESTRUCTIBLE = 1 << 2;
+
 struct TypeInfo {
     TypeInfoType type;
+    PrimitiveKind primitive_kind;
+    uint8_t traits;
     const char* type_name;
     type_id_t type_id;
     uint32_t size;
+    uint32_t alignment;
+    uint32_t type_index;
+    const TypeOps* ops;
 };
 
 struct TypeInfoArray : public TypeInfo {
@@ -98,6 +185,24 @@ struct TypeInfoIndirect : public TypeInfo {
     IndirectType indirect_type;
 };
 
+enum class ContainerType : uint8_t {
+    Vector,
+    String,
+    Array,
+    Optional
+};
+
+// Standard containers, accessed through thunks so they can be used without knowing `T`.
+// An optional has a size of 0 or 1, `resize` is nullptr if the size is fixed or the elements
+// can't be default constructed and `get_data` is nullptr if the elements aren't contiguous (`std::vector<bool>`)
+struct TypeInfoContainer : public TypeInfo {
+    const TypeInfo* underlying;
+    ContainerType container_type;
+    container_size_t get_size;
+    container_data_t get_data;
+    container_resize_t resize;
+};
+
 struct FunctionParameter {
     const TypeInfo* type_info;
     const char* name;
@@ -118,15 +223,20 @@ struct RecordField {
     const TypeInfo* type_info;
     const char* name;
     uint32_t offset;
+    uint8_t bit_width;
+    uint8_t bit_shift;
     RecordAccess access;
     int tag_count;
     const char** tags;
+    field_getter_t get;
+    field_setter_t set;
 };
 
 struct TypeInfoRecord : public TypeInfo {
     RecordType record_type;
     int parent_count;
     const TypeInfo** parents;
+    uint32_t* parent_offsets;
     int field_count;
     RecordField* fields;
     int method_count;
@@ -144,10 +254,156 @@ struct TypeInfoEnum : public TypeInfo {
     const char** tags;
 };
 
+// Type info is built lazily and can refer back to itself (e.g. `Foo` has a `Foo*` field), so initialization
+// has to be reentrant. A single recursive lock is held for an entire cascade of `info()` calls and every type
+// that is built during the cascade is only published as ready once the outermost call is done.
+// After that `info()` is a single acquire load.
+enum TypeInitState : uint8_t {
+    TYPE_UNINITIALIZED,
+    TYPE_INITIALIZING,
+    TYPE_READY
+};
+
+typedef std::atomic<uint8_t> type_init_state_t;
+
+struct TypeInitContext {
+    std::recursive_mutex mutex;
+    int depth = 0;
+    std::vector<type_init_state_t*> pending;
+
+    static TypeInitContext& get() {
+        static TypeInitContext context;
+        return context;
+    }
+};
+
+class TypeInitGuard {
+public:
+    TypeInitGuard(type_init_state_t& state) : state(state), context(TypeInitContext::get()) {
+        context.mutex.lock();
+        context.depth += 1;
+    }
+
+    ~TypeInitGuard() {
+        context.depth -= 1;
+
+        if (context.depth == 0) {
+            for (type_init_state_t* pending : context.pending) {
+                pending->store(TYPE_READY, std::memory_order_release);
+            }
+
+            context.pending.clear();
+        }
+
+        context.mutex.unlock();
+    }
+
+    // Returns false if the type is ready or is being initialized further up the call stack
+    bool should_init() {
+        if (state.load(std::memory_order_relaxed) != TYPE_UNINITIALIZED) {
+            return false;
+        }
+
+        state.store(TYPE_INITIALIZING, std::memory_order_relaxed);
+        context.pending.push_back(&state);
+        init_count() += 1;
+        return true;
+    }
+
+    // The amount of types the calling thread has initialized, so `warm_up` can tell what it built itself
+    static uint64_t& init_count() {
+        static thread_local uint64_t count = 0;
+        return count;
+    }
+
+private:
+    type_init_state_t& state;
+    TypeInitContext& context;
+};
+
 static TypeInfo UNINDEXED_TYPE_INFO = {
     TypeInfoType::Primitive,
+    PrimitiveKind::None,
+    0,
     "(unindexed)",
-    0, 0
+    0, 0, 0,
+    INVALID_TYPE_INDEX,
+    nullptr
+};
+
+template<typename T>
+struct VoidType {
+    typedef void type;
+};
+
+// `std::is_copy_constructible` is true for containers of move-only types, but copying them doesn't compile.
+// Anything with a `value_type` (the standard containers, `std::optional`) also needs copyable elements
+template<typename T, typename = void>
+struct IsCopyable : std::is_copy_constructible<T> {};
+
+template<typename T>
+struct IsCopyable<T, typename VoidType<typename T::value_type>::type> : std::integral_constant<bool,
+    std::is_copy_constructible<T>::value && IsCopyable<typename T::value_type>::value> {};
+
+// How the field accessors copy a value in and out of type-erased storage
+enum class FieldCopyMode {
+    Bitwise, // Trivially copyable, `memcpy`
+    Copy,    // Copy constructed into the output and copy assigned from the input
+    None     // Can't be copied, the accessors are nullptr
+};
+
+// Const fields only need to be copied out, they don't get a setter
+template<typename T, typename U = typename std::remove_cv<T>::type>
+struct FieldCopyModeOf : std::integral_constant<FieldCopyMode,
+    std::is_trivially_copyable<U>::value ? FieldCopyMode::Bitwise :
+    (IsCopyable<U>::value && std::is_copy_assignable<U>::value) ? FieldCopyMode::Copy :
+    FieldCopyMode::None> {};
+
+template<typename T, typename U, size_t size>
+struct FieldCopyModeOf<T [size], U [size]> : FieldCopyModeOf<T> {};
+
+template<typename T, FieldCopyMode mode = FieldCopyModeOf<T>::value>
+struct FieldCopy {
+    static void get(void* out, const T& value) {
+        memcpy(out, (const void*)&value, sizeof(T));
+    }
+
+    static void set(T& value, const void* in) {
+        memcpy((void*)&value, in, sizeof(T));
+    }
+};
+
+template<typename T>
+struct FieldCopy<T, FieldCopyMode::Copy> {
+    static void get(void* out, const T& value) {
+        new (out) T(value);
+    }
+
+    static void set(T& value, const void* in) {
+        value = *(const T*)in;
+    }
+};
+
+template<typename T, size_t size>
+struct FieldCopy<T [size], FieldCopyMode::Copy> {
+    static void get(void* out, const T (&value)[size]) {
+        for (size_t i = 0; i < size; i++) {
+            FieldCopy<T>::get((typename std::remove_cv<T>::type*)out + i, value[i]);
+        }
+    }
+
+    static void set(T (&value)[size], const void* in) {
+        for (size_t i = 0; i < size; i++) {
+            FieldCopy<T>::set(value[i], (const T*)in + i);
+        }
+    }
+};
+
+// Only instantiated so the accessors compile, they're nullptr for these fields
+template<typename T>
+struct FieldCopy<T, FieldCopyMode::None> {
+    static void get(void*, const T&) {}
+    static void set(T&, const void*) {}
 };
 
 template<typename T>
@@ -211,6 +467,109 @@ static const TypeInfo* type_of(const T& t) {
     return type_of<T>();
 }
 
+// Gets the offset of `Base` inside of `Derived` by letting the compiler do the pointer adjustment.
+// Trivial types are converted through a real (zero-initialized) object, which is well-defined and runs no code.
+// Anything else would have to be constructed, which can have side effects, so the conversion is done on storage
+// that doesn't hold a `Derived`. That's undefined by the standard, but the adjustment of a non-virtual base is a
+// constant that GCC, Clang and MSVC apply without touching the storage. Virtual bases never get here
+template<typename Derived, typename Base,
+         bool trivial = std::is_trivially_default_constructible<Derived>::value && std::is_trivially_destructible<Derived>::value>
+struct BaseOffset {
+    static uint32_t get() {
+        static Derived object;
+        return (uint32_t)((char*)static_cast<Base*>(&object) - (char*)&object);
+    }
+};
+
+template<typename Derived, typename Base>
+struct BaseOffset<Derived, Base, false> {
+    static uint32_t get() {
+        alignas(Derived) static char storage[sizeof(Derived)];
+
+        Derived* derived = (Derived*)storage;
+        return (uint32_t)((char*)static_cast<Base*>(derived) - storage);
+    }
+};
+
+template<typename Derived, typename Base>
+static uint32_t base_offset() {
+    return BaseOffset<Derived, Base>::get();
+}
+
+// Arrays and references can't be constructed with placement new, so they only get the trait flags
+template<typename T, bool enabled = std::is_default_constructible<T>::value && !std::is_array<T>::value>
+struct ConstructThunk {
+    static void construct(void* object) {
+        new (object) T();
+    }
+};
+
+template<typename T>
+struct ConstructThunk<T, false> {
+    static constexpr void (*construct)(void*) = nullptr;
+};
+
+template<typename T, bool enabled>
+struct CopyThunk {
+    static void copy(void* object, const void* other) {
+        new (object) T(*(const T*)other);
+    }
+};
+
+template<typename T>
+struct CopyThunk<T, false> {
+    static constexpr void (*copy)(void*, const void*) = nullptr;
+};
+
+template<typename T, bool enabled = std::is_move_constructible<T>::value && !std::is_array<T>::value &&
+                                    !std::is_reference<T>::value>
+struct MoveThunk {
+    static void move(void* object, void* other) {
+        new (object) T(std::move(*(T*)other));
+    }
+};
+
+template<typename T>
+struct MoveThunk<T, false> {
+    static constexpr void (*move)(void*, void*) = nullptr;
+};
+
+template<typename T, bool enabled = std::is_destructible<T>::value && !std::is_array<T>::value &&
+                                    !std::is_reference<T>::value>
+struct DestroyThunk {
+    static void destroy(void* object) {
+        ((T*)object)->~T();
+    }
+};
+
+template<typename T>
+struct DestroyThunk<T, false> {
+    static constexpr void (*destroy)(void*) = nullptr;
+};
+
+// `copyable` is false for records marked `NoCopy`, for copy constructors that are declared but don't compile
+template<typename T, bool copyable = true>
+static const TypeOps* get_type_ops() {
+    static const TypeOps ops = {
+        ConstructThunk<T>::construct,
+        CopyThunk<T, copyable && IsCopyable<T>::value && !std::is_array<T>::value && !std::is_reference<T>::value>::copy,
+        MoveThunk<T>::move,
+        DestroyThunk<T>::destroy
+    };
+
+    return &ops;
+}
+
+template<typename T, bool copyable = true>
+static void init_lifecycle(TypeInfo& type) {
+    type.alignment = alignof(T);
+    type.traits =
+        (std::is_trivially_default_constructible<T>::value ? TYPE_TRIVIALLY_CONSTRUCTIBLE : 0) |
+        (std::is_trivially_copyable<T>::value ? TYPE_TRIVIALLY_COPYABLE : 0) |
+        (std::is_trivially_destructible<T>::value ? TYPE_TRIVIALLY_DESTRUCTIBLE : 0);
+    type.ops = get_type_ops<T, copyable>();
+}
+
 template<typename Result, typename T, typename... Args>
 static Result call_method(T& t, bool& success, const char* name, const Args... args) {
     return Type<T>::template call<Result>(t, success, name, args...);
@@ -227,14 +586,26 @@ template<typename T>
 struct Type<T *> {
     static const TypeInfo* info() {
         static TypeInfoIndirect type;
+        static type_init_state_t state;
+
+        if (state.load(std::memory_order_acquire) == TYPE_READY) {
+            return &type;
+        }
+
+        TypeInitGuard guard(state);
 
-        type.type = TypeInfoType::Indirect;
-        type.type_name = "T *";
-        type.type_id = 1;
+        if (guard.should_init()) {
+            type.type = TypeInfoType::Indirect;
+            type.primitive_kind = PrimitiveKind::Pointer;
+            type.type_name = "T *";
+            type.type_id = 1;
+            type.type_index = INVALID_TYPE_INDEX;
 
-        type.size = sizeof(T *);
-        type.underlying = type_of<T>();
-        type.indirect_type = IndirectType::Pointer;
+            type.size = sizeof(T *);
+            init_lifecycle<T *>(type);
+            type.underlying = type_of<T>();
+            type.indirect_type = IndirectType::Pointer;
+        }
 
         return &type;
     }
@@ -244,14 +615,26 @@ template<typename T>
 struct Type<T &> {
     static const TypeInfo* info() {
         static TypeInfoIndirect type;
+        static type_init_state_t state;
+
+        if (state.load(std::memory_order_acquire) == TYPE_READY) {
+            return &type;
+        }
+
+        TypeInitGuard guard(state);
 
-        type.type = TypeInfoType::Indirect;
-        type.type_name = "T &";
-        type.type_id = 2;
+        if (guard.should_init()) {
+            type.type = TypeInfoType::Indirect;
+            type.primitive_kind = PrimitiveKind::Reference;
+            type.type_name = "T &";
+            type.type_id = 2;
+            type.type_index = INVALID_TYPE_INDEX;
 
-        type.size = sizeof(T &);
-        type.underlying = type_of<T>();
-        type.indirect_type = IndirectType::LReference;
+            type.size = sizeof(T &);
+            init_lifecycle<T &>(type);
+            type.underlying = type_of<T>();
+            type.indirect_type = IndirectType::LReference;
+        }
 
         return &type;
     }
@@ -261,14 +644,26 @@ template<typename T>
 struct Type<T &&> {
     static const TypeInfo* info() {
         static TypeInfoIndirect type;
+        static type_init_state_t state;
+
+        if (state.load(std::memory_order_acquire) == TYPE_READY) {
+            return &type;
+        }
+
+        TypeInitGuard guard(state);
 
-        type.type = TypeInfoType::Indirect;
-        type.type_name = "T &&";
-        type.type_id = 3;
+        if (guard.should_init()) {
+            type.type = TypeInfoType::Indirect;
+            type.primitive_kind = PrimitiveKind::Reference;
+            type.type_name = "T &&";
+            type.type_id = 3;
+            type.type_index = INVALID_TYPE_INDEX;
 
-        type.size = sizeof(T &&);
-        type.underlying = type_of<T>();
-        type.indirect_type = IndirectType::RReference;
+            type.size = sizeof(T &&);
+            init_lifecycle<T &&>(type);
+            type.underlying = type_of<T>();
+            type.indirect_type = IndirectType::RReference;
+        }
 
         return &type;
     }
@@ -278,18 +673,255 @@ template<typename T, int size>
 struct Type<T [size]> {
     static const TypeInfo* info() {
         static TypeInfoArray type;
+        static type_init_state_t state;
+
+        if (state.load(std::memory_order_acquire) == TYPE_READY) {
+            return &type;
+        }
+
+        TypeInitGuard guard(state);
 
-        type.type = TypeInfoType::Array;
-        type.type_name = "T [size]";
-        type.type_id = 4;
+        if (guard.should_init()) {
+            type.type = TypeInfoType::Array;
+            type.primitive_kind = PrimitiveKind::Array;
+            type.type_name = "T [size]";
+            type.type_id = 4;
+            type.type_index = INVALID_TYPE_INDEX;
 
-        type.size = sizeof(T [size]);
-        type.underlying = type_of<T>();
-        type.length = size;
+            type.size = sizeof(T [size]);
+            init_lifecycle<T [size]>(type);
+            type.underlying = type_of<T>();
+            type.length = size;
+        }
+
+        return &type;
+    }
+};
+
+template<typename Container>
+static size_t container_size(const void* container) {
+    return ((const Container*)container)->size();
+}
+
+template<typename Container>
+static void* container_data(void* container) {
+    Container& c = *(Container*)container;
+    return c.empty() ? nullptr : (void*)&c[0];
+}
+
+template<typename Container>
+static void container_resize(void* container, size_t size) {
+    ((Container*)container)->resize(size);
+}
+
+// The thunks are picked by overloading on a null pointer to the container,
+// so the ones that wouldn't compile for a container are never instantiated
+template<typename Container>
+static container_size_t get_container_size(const Container*) {
+    return &container_size<Container>;
+}
+
+template<typename Container>
+static container_data_t get_container_data(const Container*) {
+    return &container_data<Container>;
+}
+
+// The bits of `std::vector<bool>` can't be pointed to
+template<typename Allocator>
+static container_data_t get_container_data(const std::vector<bool, Allocator>*) {
+    return nullptr;
+}
+
+template<typename Container>
+static typename std::enable_if<std::is_default_constructible<typename Container::value_type>::value, container_resize_t>::type
+get_container_resize(const Container*) {
+    return &container_resize<Container>;
+}
+
+template<typename Container>
+static typename std::enable_if<!std::is_default_constructible<typename Container::value_type>::value, container_resize_t>::type
+get_container_resize(const Container*) {
+    return nullptr;
+}
+
+template<typename T, size_t size>
+static container_resize_t get_container_resize(const std::array<T, size>*) {
+    return nullptr;
+}
+
+#if defined(TT_HAS_OPTIONAL)
+template<typename T>
+static size_t optional_size(const void* container) {
+    return ((const std::optional<T>*)container)->has_value() ? 1 : 0;
+}
+
+template<typename T>
+static void* optional_data(void* container) {
+    std::optional<T>& optional = *(std::optional<T>*)container;
+    return optional.has_value() ? (void*)&*optional : nullptr;
+}
+
+template<typename T>
+static void optional_resize(void* container, size_t size) {
+    std::optional<T>& optional = *(std::optional<T>*)container;
+
+    if (size == 0) {
+        optional.reset();
+    } else if (!optional.has_value()) {
+        optional.emplace();
+    }
+}
+
+template<typename T>
+static container_size_t get_container_size(const std::optional<T>*) {
+    return &optional_size<T>;
+}
+
+template<typename T>
+static container_data_t get_container_data(const std::optional<T>*) {
+    return &optional_data<T>;
+}
+
+template<typename T>
+static typename std::enable_if<std::is_default_constructible<T>::value, container_resize_t>::type
+get_container_resize(const std::optional<T>*) {
+    return &optional_resize<T>;
+}
+
+template<typename T>
+static typename std::enable_if<!std::is_default_constructible<T>::value, container_resize_t>::type
+get_container_resize(const std::optional<T>*) {
+    return nullptr;
+}
+#endif
+
+template<typename Container>
+static void init_container(TypeInfoContainer& type, ContainerType container_type, const char* type_name, type_id_t type_id) {
+    const Container* container = nullptr;
+
+    type.type = TypeInfoType::Container;
+    type.primitive_kind = PrimitiveKind::None;
+    type.type_name = type_name;
+    type.type_id = type_id;
+    type.type_index = INVALID_TYPE_INDEX;
+
+    type.size = sizeof(Container);
+    init_lifecycle<Container>(type);
+    type.underlying = type_of<typename Container::value_type>();
+    type.container_type = container_type;
+    type.get_size = get_container_size(container);
+    type.get_data = get_container_data(container);
+    type.resize = get_container_resize(container);
+}
+
+template<typename T, typename Allocator>
+struct Type<std::vector<T, Allocator>> {
+    static const TypeInfo* info() {
+        static TypeInfoContainer type;
+        static type_init_state_t state;
+
+        if (state.load(std::memory_order_acquire) == TYPE_READY) {
+            return &type;
+        }
+
+        TypeInitGuard guard(state);
+
+        if (guard.should_init()) {
+            init_container<std::vector<T, Allocator>>(type, ContainerType::Vector, "std::vector<T>", 5);
+        }
+
+        return &type;
+    }
+};
+
+template<typename Char, typename Traits, typename Allocator>
+struct Type<std::basic_string<Char, Traits, Allocator>> {
+    static const TypeInfo* info() {
+        static TypeInfoContainer type;
+        static type_init_state_t state;
+
+        if (state.load(std::memory_order_acquire) == TYPE_READY) {
+            return &type;
+        }
+
+        TypeInitGuard guard(state);
+
+        if (guard.should_init()) {
+            init_container<std::basic_string<Char, Traits, Allocator>>(type, ContainerType::String, "std::basic_string<T>", 6);
+        }
+
+        return &type;
+    }
+};
+
+template<typename T, size_t size>
+struct Type<std::array<T, size>> {
+    static const TypeInfo* info() {
+        static TypeInfoContainer type;
+        static type_init_state_t state;
+
+        if (state.load(std::memory_order_acquire) == TYPE_READY) {
+            return &type;
+        }
+
+        TypeInitGuard guard(state);
+
+        if (guard.should_init()) {
+            init_container<std::array<T, size>>(type, ContainerType::Array, "std::array<T, size>", 7);
+        }
+
+        return &type;
+    }
+};
+
+#if defined(TT_HAS_OPTIONAL)
+template<typename T>
+struct Type<std::optional<T>> {
+    static const TypeInfo* info() {
+        static TypeInfoContainer type;
+        static type_init_state_t state;
+
+        if (state.load(std::memory_order_acquire) == TYPE_READY) {
+            return &type;
+        }
+
+        TypeInitGuard guard(state);
+
+        if (guard.should_init()) {
+            init_container<std::optional<T>>(type, ContainerType::Optional, "std::optional<T>", 8);
+        }
 
         return &type;
     }
 };
+#endif
+
+)";
+
+static const char* warm_up_h = R"(
+typedef const TypeInfo* (*type_info_getter_t)();
+
+struct WarmUpStats {
+    int type_count;       // The types that were initialized by this call, including the ones their fields and parents pulled in
+    uint64_t nanoseconds;
+};
+
+// Builds the type info of all `getters` in order so the first `type_of` doesn't have to
+static WarmUpStats warm_up(const type_info_getter_t* getters, int count) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t init_count = TypeInitGuard::init_count();
+
+    for (int i = 0; i < count; i++) {
+        getters[i]();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+
+    WarmUpStats stats;
+    stats.type_count = (int)(TypeInitGuard::init_count() - init_count);
+    stats.nanoseconds = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    return stats;
+}
 
 )";
 
@@ -362,6 +994,7 @@ int size = 0;
 
 TT_SPAN_HELPER(get_fields, RecordField, Record, fields, field_count);
 TT_SPAN_HELPER(get_parents, const TypeInfo*, Record, parents, parent_count);
+TT_SPAN_HELPER(get_parent_offsets, uint32_t, Record, parent_offsets, parent_count);
 TT_SPAN_HELPER(get_methods, TypeInfoFunction, Record, methods, method_count);
 TT_SPAN_HELPER(get_parameters, FunctionParameter, Function, parameters, parameter_count);
 TT_SPAN_HELPER(get_enum_names, const char*, Enum, enum_names, enum_count);
@@ -401,6 +1034,11 @@ static const TypeInfoEnum* cast(const TypeInfo* ti) {
     return (ti && ti->type == TypeInfoType::Enum) ? (const TypeInfoEnum*)ti : nullptr;
 }
 
+template<>
+static const TypeInfoContainer* cast(const TypeInfo* ti) {
+    return (ti && ti->type == TypeInfoType::Container) ? (const TypeInfoContainer*)ti : nullptr;
+}
+
 // Getting tags
 
 static Span<const char*> get_tags(const TypeInfo* ti) {
@@ -422,6 +1060,11 @@ static Span<const char*> get_tags(const RecordField* field) {
     return Span<const char*>(field->tags, field->tag_count);
 }
 
+// Without this `get_tags(&field)` would pick `get_tags<RecordField*>`
+static Span<const char*> get_tags(RecordField* field) {
+    return get_tags((const RecordField*)field);
+}
+
 static Span<const char*> get_tags(const TypeInfoArray* ti) {
     return get_tags((const TypeInfo*)ti);
 }
@@ -621,6 +1264,10 @@ static bool has_tag(const RecordField* field, const char* tag) {
     return false;
 }
 
+static bool has_tag(RecordField* field, const char* tag) {
+    return has_tag((const RecordField*)field, tag);
+}
+
 static bool has_tag(const TypeInfoArray* ti, const char* tag) {
     return has_tag((const TypeInfo*)ti, tag);
 }
@@ -663,6 +1310,9 @@ static const TypeInfo* get_underlying(const TypeInfo* ti) {
 
         case TypeInfoType::Enum:
             return ((TypeInfoEnum*)ti)->underlying;
+
+        case TypeInfoType::Container:
+            return ((TypeInfoContainer*)ti)->underlying;
     }
 
     return nullptr;
@@ -688,6 +1338,10 @@ static const TypeInfo* get_underlying(const TypeInfoEnum* ti) {
     return get_underlying((const TypeInfoEnum*)ti);
 }
 
+static const TypeInfo* get_underlying(const TypeInfoContainer* ti) {
+    return get_underlying((const TypeInfo*)ti);
+}
+
 template<typename T>
 static const TypeInfo* get_underlying() {
     return get_underlying(type_of<T>());
@@ -712,6 +1366,10 @@ static RecordAccess get_access(const RecordField* field) {
     return field->access;
 }
 
+static RecordAccess get_access(RecordField* field) {
+    return field->access;
+}
+
 static RecordAccess get_access(const TypeInfoArray* ti) {
     return get_access((const TypeInfo*)ti);
 }
@@ -742,16 +1400,100 @@ static RecordAccess get_access(const T& t) {
     return get_access(type_of<T>());
 }
 
-// Reading/writing arbitrary fields
+// Reading/writing bitfields
+// These assume a little-endian layout and are only used when a bitfield has no accessors
 
-enum class ReadWritePolicy {
-    Type,        // T must match target type
-    ExactSize,   // T must be the same size
-    FittingSize, // T must be the same size or smaller
-    Raw
-};
+// Returns true if the bitfield is a signed integer or an enum with a signed underlying type
+static bool is_signed_bitfield(const RecordField* field) {
+    const TypeInfo* ti = field->type_info;
 
-template<typename T, typename U>
+    if (const TypeInfoEnum* tie = cast<TypeInfoEnum>(ti)) {
+        ti = tie->underlying;
+    }
+
+    if (!ti) return false;
+
+    switch (ti->primitive_kind) {
+        case PrimitiveKind::I8:
+        case PrimitiveKind::I16:
+        case PrimitiveKind::I32:
+        case PrimitiveKind::I64:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+// Signed bitfields are sign-extended, so the lower bytes of the result can be copied into the field's type as is
+static uint64_t read_bitfield(const void* target, const RecordField* field) {
+    uint64_t bits = 0;
+    int byte_count = (field->bit_shift + field->bit_width + 7) / 8;
+    memcpy(&bits, (const uint8_t*)target + field->offset, (byte_count < 8) ? byte_count : 8);
+
+    bits >>= field->bit_shift;
+
+    if (field->bit_width < 64) {
+        uint64_t mask = ((uint64_t)1 << field->bit_width) - 1;
+        bits &= mask;
+
+        if (field->bit_width > 0 && is_signed_bitfield(field) && (bits >> (field->bit_width - 1)) & 1) {
+            bits |= ~mask;
+        }
+    }
+
+    return bits;
+}
+
+static void write_bitfield(void* target, const RecordField* field, uint64_t value) {
+    uint64_t bits = 0;
+    int byte_count = (field->bit_shift + field->bit_width + 7) / 8;
+    byte_count = (byte_count < 8) ? byte_count : 8;
+    memcpy(&bits, (const uint8_t*)target + field->offset, byte_count);
+
+    uint64_t mask = (field->bit_width < 64) ? ((uint64_t)1 << field->bit_width) - 1 : ~(uint64_t)0;
+    bits &= ~(mask << field->bit_shift);
+    bits |= (value & mask) << field->bit_shift;
+
+    memcpy((uint8_t*)target + field->offset, &bits, byte_count);
+}
+
+// Reading/writing arbitrary fields
+
+enum class ReadWritePolicy {
+    Type,        // T must match target type
+    ExactSize,   // T must be the same size
+    FittingSize, // T must be the same size or smaller
+    Raw
+};
+
+// Fields (or data) that aren't trivially copyable, like `std::string`, can't be copied with `memcpy`.
+// They're only copied to and from the same type, through the field accessors
+template<typename U>
+static bool is_object_copy(const RecordField* field) {
+    bool trivial_field = field->type_info->size == 0 || (field->type_info->traits & TYPE_TRIVIALLY_COPYABLE);
+    return !trivial_field || !std::is_trivially_copyable<U>::value;
+}
+
+static bool write_object_field(void* record, const RecordField* field, const TypeInfo* data_ti, const void* data) {
+    if (field->type_info->type_id != data_ti->type_id || !field->set) return false;
+
+    field->set(record, data);
+    return true;
+}
+
+static bool read_object_field(const void* record, const RecordField* field, const TypeInfo* data_ti, void* data) {
+    const TypeInfo* ti = field->type_info;
+
+    if (ti->type_id != data_ti->type_id || !field->get || !ti->ops || !ti->ops->destroy) return false;
+
+    // `get` copy constructs into its output, so the old value has to go first
+    ti->ops->destroy(data);
+    field->get(record, data);
+    return true;
+}
+
+template<typename T, typename U>
 static bool write_field(const T& target, const char* field_name, const U& data, ReadWritePolicy policy = ReadWritePolicy::Type) {
     const TypeInfoRecord* tir = cast<TypeInfoRecord>(type_of<T>());
 
@@ -770,6 +1512,10 @@ static bool write_field(const T& target, RecordField* field, const U& data, Read
 
     if (!field) return false;
 
+    if (is_object_copy<U>(field)) {
+        return write_object_field((void*)&target, field, data_ti, &data);
+    }
+
     switch (policy) {
         case ReadWritePolicy::Type:
             if (field->type_info->type_id != data_ti->type_id) return false;
@@ -782,9 +1528,26 @@ static bool write_field(const T& target, RecordField* field, const U& data, Read
         case ReadWritePolicy::FittingSize:
             if (field->type_info->size < data_ti->size && data_ti->size > 0) return false;
             break;
+
+        case ReadWritePolicy::Raw:
+            break;
     }
 
     int size = (field->type_info->size < data_ti->size) ? field->type_info->size : data_ti->size;
+
+    if (field->bit_width != 0) {
+        uint64_t value = 0;
+        memcpy(&value, &data, (size < 8) ? size : 8);
+
+        if (field->set) {
+            field->set((void*)&target, &value);
+        } else {
+            write_bitfield((void*)&target, field, value);
+        }
+
+        return true;
+    }
+
     memcpy((uint8_t*)&target + field->offset, &data, size);
     return true;
 }
@@ -808,6 +1571,10 @@ static bool read_field(const T& target, RecordField* field, const U& data, ReadW
 
     if (!field) return false;
 
+    if (is_object_copy<U>(field)) {
+        return read_object_field(&target, field, data_ti, (void*)&data);
+    }
+
     switch (policy) {
         case ReadWritePolicy::Type:
             if (field->type_info->type_id != data_ti->type_id) return false;
@@ -820,10 +1587,1857 @@ static bool read_field(const T& target, RecordField* field, const U& data, ReadW
         case ReadWritePolicy::FittingSize:
             if (field->type_info->size < data_ti->size && data_ti->size > 0) return false;
             break;
+
+        case ReadWritePolicy::Raw:
+            break;
     }
 
     int size = (field->type_info->size < data_ti->size) ? field->type_info->size : data_ti->size;
+
+    if (field->bit_width != 0) {
+        uint64_t value = 0;
+
+        if (field->get) {
+            field->get(&target, &value);
+        } else {
+            value = read_bitfield(&target, field);
+        }
+
+        memcpy((void*)&data, &value, (size < 8) ? size : 8);
+        return true;
+    }
+
     memcpy((void*)&data, (uint8_t*)&target + field->offset, size);
     return true;
 }
 )";
+
+static const char* gather_h = R"(
+// Bulk field extraction
+//
+// `gather_field` copies one field of every record into a tightly packed array and
+// `scatter_field` does the reverse. The field is resolved once and then copied
+// with a strided kernel that is specialized for the common field sizes.
+
+template<typename Word>
+static void copy_strided_words(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride, int count) {
+    for (int i = 0; i < count; i++) {
+        Word word;
+        memcpy(&word, src, sizeof(Word));
+        memcpy(dst, &word, sizeof(Word));
+
+        src += src_stride;
+        dst += dst_stride;
+    }
+}
+
+struct Word128 {
+    uint64_t low;
+    uint64_t high;
+};
+
+#if defined(__AVX2__)
+// Hardware gathers only pay off when the destination is packed, 8 elements at a time
+static int gather_avx2_32(const uint8_t* src, size_t src_stride, uint8_t* dst, int count) {
+    if (src_stride * 7 > 0x7FFFFFFF) return 0;
+
+    __m256i indices = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32((int)src_stride));
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256i values = _mm256_i32gather_epi32((const int*)(src + src_stride * i), indices, 1);
+        _mm256_storeu_si256((__m256i*)(dst + 4 * i), values);
+    }
+
+    return i;
+}
+
+static int gather_avx2_64(const uint8_t* src, size_t src_stride, uint8_t* dst, int count) {
+    __m256i indices = _mm256_setr_epi64x(0, (long long)src_stride, (long long)src_stride * 2, (long long)src_stride * 3);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m256i values = _mm256_i64gather_epi64((const long long*)(src + src_stride * i), indices, 1);
+        _mm256_storeu_si256((__m256i*)(dst + 8 * i), values);
+    }
+
+    return i;
+}
+#endif
+
+static void copy_strided(const uint8_t* src, size_t src_stride, uint8_t* dst, size_t dst_stride, uint32_t size, int count) {
+#if defined(__AVX2__)
+    if (dst_stride == size && (size == 4 || size == 8)) {
+        int done = (size == 4) ? gather_avx2_32(src, src_stride, dst, count) : gather_avx2_64(src, src_stride, dst, count);
+
+        src += src_stride * done;
+        dst += dst_stride * done;
+        count -= done;
+    }
+#endif
+
+    switch (size) {
+        case 1:
+            copy_strided_words<uint8_t>(src, src_stride, dst, dst_stride, count);
+            break;
+
+        case 2:
+            copy_strided_words<uint16_t>(src, src_stride, dst, dst_stride, count);
+            break;
+
+        case 4:
+            copy_strided_words<uint32_t>(src, src_stride, dst, dst_stride, count);
+            break;
+
+        case 8:
+            copy_strided_words<uint64_t>(src, src_stride, dst, dst_stride, count);
+            break;
+
+        case 16:
+            copy_strided_words<Word128>(src, src_stride, dst, dst_stride, count);
+            break;
+
+        default:
+            for (int i = 0; i < count; i++) {
+                memcpy(dst + dst_stride * i, src + src_stride * i, size);
+            }
+            break;
+    }
+}
+
+// Returns the amount of bytes to copy per element, or 0 if `policy` rejects `U` or it can't be copied with `memcpy`
+template<typename U>
+static uint32_t get_copy_size(const RecordField* field, ReadWritePolicy policy) {
+    const TypeInfo* data_ti = type_of<U>();
+
+    if (!field || is_object_copy<U>(field)) return 0;
+
+    switch (policy) {
+        case ReadWritePolicy::Type:
+            if (field->type_info->type_id != data_ti->type_id) return 0;
+            break;
+
+        case ReadWritePolicy::ExactSize:
+            if (field->type_info->size != sizeof(U)) return 0;
+            break;
+
+        case ReadWritePolicy::FittingSize:
+            if (field->type_info->size < sizeof(U)) return 0;
+            break;
+
+        case ReadWritePolicy::Raw:
+            break;
+    }
+
+    return (field->type_info->size < sizeof(U)) ? field->type_info->size : (uint32_t)sizeof(U);
+}
+
+template<typename T, typename U>
+static bool gather_field(Span<T> records, const RecordField* field, U* out, ReadWritePolicy policy = ReadWritePolicy::Type) {
+    // Fields that aren't trivially copyable are copied one by one through their accessors, only to the same type
+    if (field && is_object_copy<U>(field)) {
+        for (int i = 0; i < records.length(); i++) {
+            if (!read_field(records.data()[i], (RecordField*)field, out[i])) return false;
+        }
+
+        return true;
+    }
+
+    uint32_t size = get_copy_size<U>(field, policy);
+
+    if (size == 0) return false;
+
+    // Bitfields have no address, so they're copied one by one
+    if (field->bit_width != 0) {
+        for (int i = 0; i < records.length(); i++) {
+            read_field(records.data()[i], (RecordField*)field, out[i], ReadWritePolicy::Raw);
+        }
+
+        return true;
+    }
+
+    copy_strided((const uint8_t*)records.data() + field->offset, sizeof(T), (uint8_t*)out, sizeof(U), size, records.length());
+    return true;
+}
+
+template<typename T, typename U>
+static bool gather_field(Span<T> records, const char* field_name, U* out, ReadWritePolicy policy = ReadWritePolicy::Type) {
+    return gather_field(records, get_field<T>(field_name), out, policy);
+}
+
+template<typename T, typename U>
+static bool scatter_field(Span<T> records, const RecordField* field, const U* in, ReadWritePolicy policy = ReadWritePolicy::Type) {
+    if (field && is_object_copy<U>(field)) {
+        for (int i = 0; i < records.length(); i++) {
+            if (!write_field(records.data()[i], (RecordField*)field, in[i])) return false;
+        }
+
+        return true;
+    }
+
+    uint32_t size = get_copy_size<U>(field, policy);
+
+    if (size == 0) return false;
+
+    if (field->bit_width != 0) {
+        for (int i = 0; i < records.length(); i++) {
+            write_field(records.data()[i], (RecordField*)field, in[i], ReadWritePolicy::Raw);
+        }
+
+        return true;
+    }
+
+    copy_strided((const uint8_t*)in, sizeof(U), (uint8_t*)records.data() + field->offset, sizeof(T), size, records.length());
+    return true;
+}
+
+template<typename T, typename U>
+static bool scatter_field(Span<T> records, const char* field_name, const U* in, ReadWritePolicy policy = ReadWritePolicy::Type) {
+    return scatter_field(records, get_field<T>(field_name), in, policy);
+}
+)";
+
+static const char* soa_h = R"(
+// Struct-of-arrays container
+//
+// Every indexed field of `T` (including the fields of its parents) is stored in its own column.
+// Columns are contiguous and aligned to `SOA_ALIGNMENT` so hot loops only touch the fields they use.
+// Fields are copied with `memcpy` (or the bitfield accessors), so `T` has to be trivially copyable.
+// `get` (and everything that reads elements back) value-initializes a `T`, so it also has to be default constructible.
+// Fields that are unindexed or `DoNotIndex` are not stored and will be value-initialized when read back.
+
+static const int SOA_ALIGNMENT = 64;
+
+struct SoAColumn {
+    const RecordField* field; // nullptr if the column holds an entire union
+    uint32_t base;            // The offset of the record that contains `field`
+    uint32_t size;            // The size of one element
+    uint8_t* data;
+};
+
+static void soa_read_column(const void* object, const SoAColumn& column, void* out) {
+    const uint8_t* record = (const uint8_t*)object + column.base;
+
+    if (!column.field) {
+        memcpy(out, record, column.size);
+        return;
+    }
+
+    if (column.field->bit_width != 0) {
+        uint64_t value = 0;
+
+        if (column.field->get) {
+            column.field->get(record, &value);
+        } else {
+            value = read_bitfield(record, column.field);
+        }
+
+        memcpy(out, &value, (column.size < 8) ? column.size : 8);
+        return;
+    }
+
+    memcpy(out, record + column.field->offset, column.size);
+}
+
+static void soa_write_column(void* object, const SoAColumn& column, const void* in) {
+    uint8_t* record = (uint8_t*)object + column.base;
+
+    if (!column.field) {
+        memcpy(record, in, column.size);
+        return;
+    }
+
+    if (column.field->bit_width != 0) {
+        uint64_t value = 0;
+        memcpy(&value, in, (column.size < 8) ? column.size : 8);
+
+        if (column.field->set) {
+            column.field->set(record, &value);
+        } else {
+            write_bitfield(record, column.field, value);
+        }
+
+        return;
+    }
+
+    memcpy(record + column.field->offset, in, column.size);
+}
+
+template<typename T>
+class SoA;
+
+// Proxy reference to a single element of a `SoA<T>`
+template<typename T>
+class SoARef {
+public:
+    SoARef(SoA<T>* soa, int index) : soa(soa), index(index) {}
+
+    // Returns a pointer to the field inside of its column, nullptr if the field doesn't exist or `U` doesn't match
+    template<typename U>
+    U* field(const char* field_name) const {
+        return field<U>(soa->column_index(field_name));
+    }
+
+    // Same as above with a column index from `SoA<T>::column_index`, which skips the lookup by name
+    template<typename U>
+    U* field(int column_index) const {
+        Span<U> column = soa->template column<U>(column_index);
+        return (column.data()) ? column.data() + index : nullptr;
+    }
+
+    operator T() const {
+        return soa->get(index);
+    }
+
+    SoARef& operator=(const T& value) {
+        soa->set(index, value);
+        return *this;
+    }
+
+private:
+    SoA<T>* soa;
+    int index;
+};
+
+template<typename T>
+class SoA {
+    static_assert(std::is_trivially_copyable<T>::value, "SoA<T> copies fields with memcpy, T must be trivially copyable");
+
+public:
+    SoA() {
+        add_columns(type_of<T>(), 0);
+    }
+
+    SoA(const T* values, int count) : SoA() {
+        from_aos(values, count);
+    }
+
+    SoA(const SoA&) = delete;
+    SoA& operator=(const SoA&) = delete;
+
+    ~SoA() {
+        free(block);
+        free(columns);
+    }
+
+    inline int length() const {
+        return count;
+    }
+
+    inline int column_count() const {
+        return columns_count;
+    }
+
+    inline const SoAColumn& get_column(int index) const {
+        return columns[index];
+    }
+
+    // Returns false if the allocation failed, the container is left as is
+    bool reserve(int new_capacity) {
+        if (new_capacity <= capacity) return true;
+
+        size_t block_size = SOA_ALIGNMENT;
+        for (int i = 0; i < columns_count; i++) {
+            block_size += align(columns[i].size * (size_t)new_capacity);
+        }
+
+        uint8_t* new_block = (uint8_t*)malloc(block_size);
+        if (!new_block) return false;
+
+        uint8_t* cursor = (uint8_t*)align((size_t)new_block);
+
+        for (int i = 0; i < columns_count; i++) {
+            if (count > 0) {
+                memcpy(cursor, columns[i].data, columns[i].size * (size_t)count);
+            }
+
+            columns[i].data = cursor;
+            cursor += align(columns[i].size * (size_t)new_capacity);
+        }
+
+        free(block);
+        block = new_block;
+        capacity = new_capacity;
+        return true;
+    }
+
+    void clear() {
+        count = 0;
+    }
+
+    // Returns false if there was no room and growing the container failed
+    bool push(const T& value) {
+        if (count == capacity && !reserve((capacity > 0) ? capacity * 2 : 16)) {
+            return false;
+        }
+
+        count += 1;
+        set(count - 1, value);
+        return true;
+    }
+
+    // Removes the element and shifts all the following elements down, keeping the order intact
+    void erase(int index) {
+        if (index < 0 || index >= count) return;
+
+        for (int i = 0; i < columns_count; i++) {
+            uint8_t* elem = columns[i].data + columns[i].size * (size_t)index;
+            memmove(elem, elem + columns[i].size, columns[i].size * (size_t)(count - index - 1));
+        }
+
+        count -= 1;
+    }
+
+    T get(int index) const {
+        T value{};
+
+        for (int i = 0; i < columns_count; i++) {
+            soa_write_column(&value, columns[i], columns[i].data + columns[i].size * (size_t)index);
+        }
+
+        return value;
+    }
+
+    void set(int index, const T& value) {
+        for (int i = 0; i < columns_count; i++) {
+            soa_read_column(&value, columns[i], columns[i].data + columns[i].size * (size_t)index);
+        }
+    }
+
+    SoARef<T> operator[](int index) {
+        return SoARef<T>(this, index);
+    }
+
+    // Returns the index of the column of a field, -1 if the field isn't stored.
+    // Column indices never change, so look it up once and use `column<U>(int)` in loops instead of the name
+    int column_index(const char* field_name) const {
+        // Search from the back so fields of `T` shadow fields of its parents
+        for (int i = columns_count - 1; i >= 0; i--) {
+            if (columns[i].field && strcmp(columns[i].field->name, field_name) == 0) {
+                return i;
+            }
+        }
+
+        return -1;
+    }
+
+    int column_index(const RecordField* field) const {
+        for (int i = 0; i < columns_count; i++) {
+            if (columns[i].field == field) return i;
+        }
+
+        return -1;
+    }
+
+    // Returns the column of a field, empty if the field doesn't exist or `U` doesn't match the field type
+    template<typename U>
+    Span<U> column(int column_index) {
+        if (column_index < 0 || column_index >= columns_count) return Span<U>(nullptr, 0);
+
+        const RecordField* field = columns[column_index].field;
+        if (!field || field->type_info->type_id != type_of<U>()->type_id) {
+            return Span<U>(nullptr, 0);
+        }
+
+        return Span<U>((U*)columns[column_index].data, count);
+    }
+
+    template<typename U>
+    Span<U> column(const char* field_name) {
+        return column<U>(column_index(field_name));
+    }
+
+    template<typename U>
+    Span<U> column(const RecordField* field) {
+        return column<U>(column_index(field));
+    }
+
+    // Conversion to and from array-of-structs
+    void to_aos(T* out) const {
+        for (int i = 0; i < count; i++) {
+            out[i] = get(i);
+        }
+    }
+
+    // Returns false if the allocation failed, no values are added in that case
+    bool from_aos(const T* values, int values_count) {
+        if (!reserve(count + values_count)) return false;
+
+        for (int i = 0; i < values_count; i++) {
+            push(values[i]);
+        }
+
+        return true;
+    }
+
+private:
+    static size_t align(size_t size) {
+        return (size + SOA_ALIGNMENT - 1) & ~(size_t)(SOA_ALIGNMENT - 1);
+    }
+
+    // If the allocation fails the field isn't stored, the same as an unindexed field
+    void add_column(const RecordField* field, uint32_t base, uint32_t size) {
+        SoAColumn* new_columns = (SoAColumn*)realloc(columns, sizeof(SoAColumn) * (columns_count + 1));
+        if (!new_columns) return;
+
+        columns = new_columns;
+        columns[columns_count] = { field, base, size, nullptr };
+        columns_count += 1;
+    }
+
+    void add_columns(const TypeInfo* ti, uint32_t base) {
+        const TypeInfoRecord* tir = cast<TypeInfoRecord>(ti);
+
+        if (!tir) return;
+
+        // The fields of a union overlap, so we store it as a whole
+        if (tir->record_type == RecordType::Union) {
+            if (tir->traits & TYPE_TRIVIALLY_COPYABLE) {
+                add_column(nullptr, base, tir->size);
+            }
+
+            return;
+        }
+
+        for (int i = 0; i < tir->parent_count; i++) {
+            if (tir->parent_offsets[i] != UNKNOWN_OFFSET) {
+                add_columns(tir->parents[i], base + tir->parent_offsets[i]);
+            }
+        }
+
+        // Fields that can't be copied with `memcpy` (e.g. `std::string`) are skipped, the same as unindexed ones
+        for (auto& field : get_fields(tir)) {
+            if (field.type_info->size > 0 && (field.type_info->traits & TYPE_TRIVIALLY_COPYABLE)) {
+                add_column(&field, base, field.type_info->size);
+            }
+        }
+    }
+
+    SoAColumn* columns = nullptr;
+    int columns_count = 0;
+
+    uint8_t* block = nullptr;
+    int count = 0;
+    int capacity = 0;
+};
+)";
+
+static const char* clone_h = R"(
+// Deep cloning
+//
+// `deep_clone` copies an object and everything it points to into a caller-supplied arena.
+// Objects are copied as a whole and afterwards the pointers inside of the copy are patched. Trivially copyable
+// objects are copied with `memcpy`, others (e.g. records with a `std::string` field) with their copy constructor.
+// The arena never runs destructors, so clones of the latter have to be destroyed by the caller.
+// Only pointers to indexed records are followed, other pointers (e.g. `const char*`) are copied as-is. Unions are not walked.
+// Objects that are pointed to multiple times are only cloned once, so aliasing and cycles are preserved.
+
+// A simple bump allocator, any arena with a matching `allocate` can be used with `deep_clone`
+class BumpArena {
+public:
+    BumpArena(void* buffer, size_t size) : buffer((uint8_t*)buffer), size(size) {}
+
+    // Returns nullptr if the arena is full
+    void* allocate(size_t alloc_size, size_t alignment) {
+        size_t start = (offset + alignment - 1) & ~(alignment - 1);
+
+        if (start + alloc_size > size) return nullptr;
+
+        offset = start + alloc_size;
+        return buffer + start;
+    }
+
+    void reset() {
+        offset = 0;
+    }
+
+    inline size_t used() const {
+        return offset;
+    }
+
+private:
+    uint8_t* buffer;
+    size_t size;
+    size_t offset = 0;
+};
+
+// Open-addressing pointer map used to track what has already been cloned
+class PointerMap {
+public:
+    PointerMap() = default;
+    PointerMap(const PointerMap&) = delete;
+    PointerMap& operator=(const PointerMap&) = delete;
+
+    ~PointerMap() {
+        free(slots);
+    }
+
+    void* find(const void* key) const {
+        if (!slots) return nullptr;
+
+        for (size_t i = hash(key) & (capacity - 1);; i = (i + 1) & (capacity - 1)) {
+            if (slots[i].key == key) return slots[i].value;
+            if (slots[i].key == nullptr) return nullptr;
+        }
+    }
+
+    void insert(const void* key, void* value) {
+        if ((count + 1) * 2 > capacity) {
+            grow();
+        }
+
+        size_t i = hash(key) & (capacity - 1);
+        while (slots[i].key != nullptr && slots[i].key != key) {
+            i = (i + 1) & (capacity - 1);
+        }
+
+        if (slots[i].key == nullptr) {
+            count += 1;
+        }
+
+        slots[i].key = key;
+        slots[i].value = value;
+    }
+
+private:
+    struct Slot {
+        const void* key;
+        void* value;
+    };
+
+    static size_t hash(const void* key) {
+        uint64_t h = (uint64_t)(uintptr_t)key;
+        h ^= h >> 33;
+        h *= 0xFF51AFD7ED558CCDull;
+        h ^= h >> 33;
+        return (size_t)h;
+    }
+
+    void grow() {
+        Slot* old_slots = slots;
+        size_t old_capacity = capacity;
+
+        capacity = (capacity > 0) ? capacity * 2 : 64;
+        slots = (Slot*)calloc(capacity, sizeof(Slot));
+        count = 0;
+
+        for (size_t i = 0; i < old_capacity; i++) {
+            if (old_slots[i].key) {
+                insert(old_slots[i].key, old_slots[i].value);
+            }
+        }
+
+        free(old_slots);
+    }
+
+    Slot* slots = nullptr;
+    size_t capacity = 0;
+    size_t count = 0;
+};
+
+template<typename Arena>
+class Cloner {
+public:
+    Cloner(Arena& arena) : arena(arena) {}
+
+    Cloner(const Cloner&) = delete;
+    Cloner& operator=(const Cloner&) = delete;
+
+    ~Cloner() {
+        free(pending);
+    }
+
+    void* clone(const void* src, const TypeInfo* ti, size_t alignment) {
+        void* dst = copy(src, ti, alignment);
+
+        // Patching is done with a worklist so long linked lists don't overflow the stack
+        while (pending_count > 0 && !failed) {
+            Pending p = pending[--pending_count];
+            patch(p.object, p.type_info);
+        }
+
+        return (failed) ? nullptr : dst;
+    }
+
+private:
+    struct Pending {
+        void* object;
+        const TypeInfo* type_info;
+    };
+
+    void* copy(const void* src, const TypeInfo* ti, size_t alignment) {
+        if (void* existing = visited.find(src)) {
+            return existing;
+        }
+
+        void* dst = arena.allocate(ti->size, alignment);
+
+        if (!dst) {
+            failed = true;
+            return nullptr;
+        }
+
+        if (ti->traits & TYPE_TRIVIALLY_COPYABLE) {
+            memcpy(dst, src, ti->size);
+        } else if (ti->ops && ti->ops->copy) {
+            ti->ops->copy(dst, src);
+        } else {
+            failed = true;
+            return nullptr;
+        }
+
+        visited.insert(src, dst);
+
+        if (contains_pointers(ti)) {
+            if (pending_count == pending_capacity) {
+                pending_capacity = (pending_capacity > 0) ? pending_capacity * 2 : 64;
+                pending = (Pending*)realloc(pending, sizeof(Pending) * pending_capacity);
+            }
+
+            pending[pending_count++] = { dst, ti };
+        }
+
+        return dst;
+    }
+
+    // Types without type info (e.g. unindexed ones) have no alignment,
+    // so we use the largest power of two that divides the size
+    static size_t get_alignment(const TypeInfo* ti) {
+        if (ti->alignment > 0) return ti->alignment;
+
+        size_t alignment = 16;
+        while (alignment > 1 && ti->size % alignment != 0) {
+            alignment /= 2;
+        }
+
+        return alignment;
+    }
+
+    static bool is_followable(const TypeInfo* ti) {
+        const TypeInfoIndirect* tii = cast<TypeInfoIndirect>(ti);
+
+        return tii && tii->indirect_type == IndirectType::Pointer &&
+            tii->underlying->type == TypeInfoType::Record && tii->underlying->size > 0;
+    }
+
+    bool contains_pointers(const TypeInfo* ti) {
+        if (is_followable(ti)) return true;
+
+        if (const TypeInfoArray* tia = cast<TypeInfoArray>(ti)) {
+            return contains_pointers(tia->underlying);
+        }
+
+        const TypeInfoRecord* tir = cast<TypeInfoRecord>(ti);
+        if (!tir || tir->record_type == RecordType::Union) return false;
+
+        // Cache the result because arrays of records ask this for every element
+        if (void* cached = has_pointers.find(ti)) {
+            return cached == (void*)&has_pointers;
+        }
+
+        bool result = false;
+        for (int i = 0; i < tir->parent_count && !result; i++) {
+            result = tir->parent_offsets[i] != UNKNOWN_OFFSET && contains_pointers(tir->parents[i]);
+        }
+
+        for (int i = 0; i < tir->field_count && !result; i++) {
+            result = tir->fields[i].bit_width == 0 && contains_pointers(tir->fields[i].type_info);
+        }
+
+        has_pointers.insert(ti, result ? (void*)&has_pointers : (void*)this);
+        return result;
+    }
+
+    void patch(void* object, const TypeInfo* ti) {
+        if (is_followable(ti)) {
+            void*& target = *(void**)object;
+
+            if (target) {
+                const TypeInfo* pointee = ((const TypeInfoIndirect*)ti)->underlying;
+                target = copy(target, pointee, get_alignment(pointee));
+            }
+
+            return;
+        }
+
+        if (!contains_pointers(ti)) return;
+
+        if (const TypeInfoArray* tia = cast<TypeInfoArray>(ti)) {
+            for (int64_t i = 0; i < tia->length; i++) {
+                patch((uint8_t*)object + tia->underlying->size * i, tia->underlying);
+            }
+
+            return;
+        }
+
+        const TypeInfoRecord* tir = (const TypeInfoRecord*)ti;
+
+        for (int i = 0; i < tir->parent_count; i++) {
+            if (tir->parent_offsets[i] != UNKNOWN_OFFSET) {
+                patch((uint8_t*)object + tir->parent_offsets[i], tir->parents[i]);
+            }
+        }
+
+        for (int i = 0; i < tir->field_count; i++) {
+            if (tir->fields[i].bit_width == 0) {
+                patch((uint8_t*)object + tir->fields[i].offset, tir->fields[i].type_info);
+            }
+        }
+    }
+
+    Arena& arena;
+    PointerMap visited;
+    PointerMap has_pointers;
+
+    Pending* pending = nullptr;
+    int pending_count = 0;
+    int pending_capacity = 0;
+    bool failed = false;
+};
+
+// Returns nullptr if `src` is nullptr, `T` is not indexed, an object can't be copied or the arena ran out of memory
+template<typename T, typename Arena>
+static T* deep_clone(const T* src, Arena& arena) {
+    const TypeInfo* ti = type_of<T>();
+
+    if (!src || ti->size == 0) return nullptr;
+
+    Cloner<Arena> cloner(arena);
+    return (T*)cloner.clone(src, ti, alignof(T));
+}
+
+template<typename T, typename Arena>
+static T* deep_clone(const T& src, Arena& arena) {
+    return deep_clone(&src, arena);
+}
+)";
+
+static const char* delta_h = R"(
+// Field-level diffing
+//
+// `diff` compares two records field by field and writes a delta: a bitmask with one bit per
+// replicated field, followed by the bytes of every changed field in order. `apply` writes a delta into a record.
+// Fields of parents and nested records are flattened, fields tagged `NoReplicate` (or with a type tagged `NoReplicate`) are skipped.
+// So are fields that aren't trivially copyable, like containers, because their bytes are only meaningful in the same process.
+// Adjacent fields are coalesced into runs so unchanged runs only cost a single `memcmp`.
+
+struct DeltaField {
+    const RecordField* field; // Only set for bitfields, which can't be compared with `memcmp`
+    uint32_t offset;          // The absolute offset, for bitfields the offset of the record that contains it
+    uint32_t size;
+};
+
+struct DeltaRun {
+    uint32_t offset;
+    uint32_t size;
+    int first_field;
+    int field_count;
+};
+
+struct DeltaLayout {
+    DeltaField* fields = nullptr;
+    int field_count = 0;
+    DeltaRun* runs = nullptr;
+    int run_count = 0;
+    int mask_size = 0;
+    int max_size = 0;
+};
+
+static void add_delta_field(DeltaLayout& layout, const RecordField* field, uint32_t offset, uint32_t size) {
+    layout.fields = (DeltaField*)realloc(layout.fields, sizeof(DeltaField) * (layout.field_count + 1));
+    layout.fields[layout.field_count] = { field, offset, size };
+    layout.field_count += 1;
+}
+
+static void add_delta_fields(DeltaLayout& layout, const TypeInfo* ti, uint32_t base) {
+    const TypeInfoRecord* tir = cast<TypeInfoRecord>(ti);
+
+    // Fields that can't be compared and copied with `memcpy` (e.g. `std::string`) are skipped, the same as unindexed ones
+    if (!tir || tir->record_type == RecordType::Union) {
+        if (ti->size > 0 && (ti->traits & TYPE_TRIVIALLY_COPYABLE)) {
+            add_delta_field(layout, nullptr, base, ti->size);
+        }
+
+        return;
+    }
+
+    for (int i = 0; i < tir->parent_count; i++) {
+        if (tir->parent_offsets[i] != UNKNOWN_OFFSET && !has_tag(tir->parents[i], "NoReplicate")) {
+            add_delta_fields(layout, tir->parents[i], base + tir->parent_offsets[i]);
+        }
+    }
+
+    for (auto& field : get_fields(tir)) {
+        if (has_tag(&field, "NoReplicate") || has_tag(field.type_info, "NoReplicate")) continue;
+
+        if (field.bit_width != 0) {
+            add_delta_field(layout, &field, base, field.type_info->size);
+        } else {
+            add_delta_fields(layout, field.type_info, base + field.offset);
+        }
+    }
+}
+
+static DeltaLayout create_delta_layout(const TypeInfo* ti) {
+    DeltaLayout layout;
+    add_delta_fields(layout, ti, 0);
+
+    layout.runs = (DeltaRun*)malloc(sizeof(DeltaRun) * (layout.field_count + 1));
+    layout.mask_size = (layout.field_count + 7) / 8;
+    layout.max_size = layout.mask_size;
+
+    for (int i = 0; i < layout.field_count; i++) {
+        const DeltaField& field = layout.fields[i];
+        layout.max_size += field.size;
+
+        DeltaRun* last = (layout.run_count > 0) ? &layout.runs[layout.run_count - 1] : nullptr;
+        bool is_adjacent = last && !field.field && !layout.fields[last->first_field].field &&
+            last->offset + last->size == field.offset;
+
+        if (is_adjacent) {
+            last->size += field.size;
+            last->field_count += 1;
+        } else {
+            layout.runs[layout.run_count++] = { field.offset, field.size, i, 1 };
+        }
+    }
+
+    return layout;
+}
+
+// The layout is created once per type
+template<typename T>
+static const DeltaLayout& get_delta_layout() {
+    static DeltaLayout layout = create_delta_layout(type_of<T>());
+    return layout;
+}
+
+// Returns the size of the largest possible delta of `T`
+template<typename T>
+static int delta_max_size() {
+    return get_delta_layout<T>().max_size;
+}
+
+static uint64_t read_delta_bitfield(const void* object, const DeltaField& field) {
+    const uint8_t* record = (const uint8_t*)object + field.offset;
+    uint64_t value = 0;
+
+    if (field.field->get) {
+        field.field->get(record, &value);
+    } else {
+        value = read_bitfield(record, field.field);
+    }
+
+    return value;
+}
+
+// Writes the delta from `a` to `b` into `out_delta`
+// Returns the size of the delta, or -1 if `out_capacity` is too small
+template<typename T>
+static int diff(const T& a, const T& b, uint8_t* out_delta, int out_capacity) {
+    const DeltaLayout& layout = get_delta_layout<T>();
+
+    if (out_capacity < layout.mask_size) return -1;
+
+    memset(out_delta, 0, layout.mask_size);
+    int size = layout.mask_size;
+
+    const uint8_t* a_bytes = (const uint8_t*)&a;
+    const uint8_t* b_bytes = (const uint8_t*)&b;
+
+    for (int r = 0; r < layout.run_count; r++) {
+        const DeltaRun& run = layout.runs[r];
+
+        if (run.field_count > 1 && memcmp(a_bytes + run.offset, b_bytes + run.offset, run.size) == 0) {
+            continue;
+        }
+
+        for (int i = run.first_field; i < run.first_field + run.field_count; i++) {
+            const DeltaField& field = layout.fields[i];
+
+            if (field.field) {
+                uint64_t a_value = read_delta_bitfield(a_bytes, field);
+                uint64_t b_value = read_delta_bitfield(b_bytes, field);
+
+                if (a_value == b_value) continue;
+                if (size + (int)field.size > out_capacity) return -1;
+
+                memcpy(out_delta + size, &b_value, field.size);
+            } else {
+                if (memcmp(a_bytes + field.offset, b_bytes + field.offset, field.size) == 0) continue;
+                if (size + (int)field.size > out_capacity) return -1;
+
+                memcpy(out_delta + size, b_bytes + field.offset, field.size);
+            }
+
+            out_delta[i / 8] |= (uint8_t)(1 << (i % 8));
+            size += field.size;
+        }
+    }
+
+    return size;
+}
+
+// Returns false if the delta is malformed
+template<typename T>
+static bool apply(T& target, const uint8_t* delta, int delta_size) {
+    const DeltaLayout& layout = get_delta_layout<T>();
+
+    if (delta_size < layout.mask_size) return false;
+
+    uint8_t* bytes = (uint8_t*)&target;
+    int offset = layout.mask_size;
+
+    for (int i = 0; i < layout.field_count; i++) {
+        if ((delta[i / 8] & (1 << (i % 8))) == 0) continue;
+
+        const DeltaField& field = layout.fields[i];
+
+        if (offset + (int)field.size > delta_size) return false;
+
+        if (field.field) {
+            uint64_t value = 0;
+            memcpy(&value, delta + offset, field.size);
+
+            if (field.field->set) {
+                field.field->set(bytes + field.offset, &value);
+            } else {
+                write_bitfield(bytes + field.offset, field.field, value);
+            }
+        } else {
+            memcpy(bytes + field.offset, delta + offset, field.size);
+        }
+
+        offset += field.size;
+    }
+
+    return true;
+}
+)";
+
+static const char* any_h = R"(
+// Type-erased values
+//
+// `Any` holds a single value and `AnyVector` a contiguous array of values of a type only known at runtime.
+// Values are managed through the lifecycle thunks of their type info, the trait flags let trivial types
+// skip the thunks and get copied with `memcpy` instead.
+
+// Returns false if the type can't be default constructed
+static bool construct_value(const TypeInfo* ti, void* object) {
+    // Trivial types are zeroed, the same as `T()`
+    if (ti->traits & TYPE_TRIVIALLY_CONSTRUCTIBLE) {
+        memset(object, 0, ti->size);
+        return true;
+    }
+
+    if (!ti->ops || !ti->ops->construct) return false;
+
+    ti->ops->construct(object);
+    return true;
+}
+
+// Returns false if the type can't be copied
+static bool copy_value(const TypeInfo* ti, void* object, const void* other) {
+    if (ti->traits & TYPE_TRIVIALLY_COPYABLE) {
+        memcpy(object, other, ti->size);
+        return true;
+    }
+
+    if (!ti->ops || !ti->ops->copy) return false;
+
+    ti->ops->copy(object, other);
+    return true;
+}
+
+// Falls back to copying if the type can't be moved, `other` still has to be destroyed afterwards
+static bool move_value(const TypeInfo* ti, void* object, void* other) {
+    if (ti->traits & TYPE_TRIVIALLY_COPYABLE) {
+        memcpy(object, other, ti->size);
+        return true;
+    }
+
+    if (ti->ops && ti->ops->move) {
+        ti->ops->move(object, other);
+        return true;
+    }
+
+    return copy_value(ti, object, other);
+}
+
+static void destroy_value(const TypeInfo* ti, void* object) {
+    if (ti->traits & TYPE_TRIVIALLY_DESTRUCTIBLE) return;
+
+    if (ti->ops && ti->ops->destroy) {
+        ti->ops->destroy(object);
+    }
+}
+
+// `operator new` only guarantees the alignment of `max_align_t`, so the original pointer is stored right before the result.
+// It goes through the global `operator new` so replacing it (e.g. to count allocations) also covers `Any` and `AnyVector`
+static void* allocate_aligned(size_t size, size_t alignment) {
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+
+    uint8_t* memory = (uint8_t*)::operator new(size + alignment + sizeof(void*), std::nothrow);
+    if (!memory) return nullptr;
+
+    uintptr_t start = (uintptr_t)(memory + sizeof(void*));
+    uint8_t* aligned = (uint8_t*)((start + alignment - 1) & ~(uintptr_t)(alignment - 1));
+    ((void**)aligned)[-1] = memory;
+
+    return aligned;
+}
+
+static void free_aligned(void* pointer) {
+    if (pointer) ::operator delete(((void**)pointer)[-1]);
+}
+
+class Any {
+public:
+    // Values that fit and aren't over-aligned are stored inline without allocating
+    static const size_t INLINE_SIZE = 3 * sizeof(void*);
+
+    Any() {}
+
+    Any(const Any& other) {
+        if (other.ti) assign(other.ti, other.value);
+    }
+
+    Any(Any&& other) {
+        take(other);
+    }
+
+    template<typename T, typename = typename std::enable_if<!std::is_same<typename std::decay<T>::type, Any>::value>::type>
+    Any(const T& value) {
+        assign(type_of<T>(), &value);
+    }
+
+    // Default constructs a value of type `ti`
+    explicit Any(const TypeInfo* ti) {
+        emplace(ti);
+    }
+
+    ~Any() {
+        reset();
+    }
+
+    Any& operator=(const Any& other) {
+        if (this != &other) {
+            if (other.ti) {
+                assign(other.ti, other.value);
+            } else {
+                reset();
+            }
+        }
+
+        return *this;
+    }
+
+    Any& operator=(Any&& other) {
+        if (this != &other) {
+            reset();
+            take(other);
+        }
+
+        return *this;
+    }
+
+    // Replaces the value with a default constructed one, returns false (and is left empty) if the type can't be constructed
+    bool emplace(const TypeInfo* ti) {
+        reset();
+        if (!allocate(ti)) return false;
+
+        if (!construct_value(ti, value)) {
+            deallocate();
+            return false;
+        }
+
+        return true;
+    }
+
+    // Replaces the value with a copy of `other`, an object of type `ti`.
+    // Returns false (and is left empty) if the type can't be copied
+    bool assign(const TypeInfo* ti, const void* other) {
+        reset();
+        if (!other || !allocate(ti)) return false;
+
+        if (!copy_value(ti, value, other)) {
+            deallocate();
+            return false;
+        }
+
+        return true;
+    }
+
+    void reset() {
+        if (!ti) return;
+
+        destroy_value(ti, value);
+        deallocate();
+    }
+
+    bool empty() const {
+        return ti == nullptr;
+    }
+
+    // nullptr if empty
+    const TypeInfo* type() const {
+        return ti;
+    }
+
+    void* data() {
+        return value;
+    }
+
+    const void* data() const {
+        return value;
+    }
+
+    // Returns nullptr if the value isn't a `T`
+    template<typename T>
+    T* get() {
+        return (ti && ti->type_id == type_of<T>()->type_id) ? (T*)value : nullptr;
+    }
+
+    template<typename T>
+    const T* get() const {
+        return (ti && ti->type_id == type_of<T>()->type_id) ? (const T*)value : nullptr;
+    }
+
+private:
+    // Types without an alignment aren't indexed, so we don't know how to handle them
+    bool allocate(const TypeInfo* type) {
+        if (!type || type->alignment == 0) return false;
+
+        if (type->size <= INLINE_SIZE && type->alignment <= alignof(std::max_align_t)) {
+            value = storage;
+        } else {
+            value = allocate_aligned(type->size, type->alignment);
+            if (!value) return false;
+        }
+
+        ti = type;
+        return true;
+    }
+
+    void deallocate() {
+        if (value != storage) free_aligned(value);
+
+        ti = nullptr;
+        value = nullptr;
+    }
+
+    // Heap values are handed over as is, inline values are moved and `other` is left empty
+    void take(Any& other) {
+        if (!other.ti) return;
+
+        if (other.value != other.storage) {
+            ti = other.ti;
+            value = other.value;
+            other.ti = nullptr;
+            other.value = nullptr;
+            return;
+        }
+
+        allocate(other.ti);
+
+        if (!move_value(ti, value, other.value)) {
+            deallocate();
+            return;
+        }
+
+        other.reset();
+    }
+
+    const TypeInfo* ti = nullptr;
+    void* value = nullptr;
+    alignas(std::max_align_t) uint8_t storage[INLINE_SIZE];
+};
+
+class AnyVector {
+public:
+    explicit AnyVector(const TypeInfo* ti) : ti(ti) {}
+
+    AnyVector(const AnyVector& other) = delete;
+    AnyVector& operator=(const AnyVector& other) = delete;
+
+    AnyVector(AnyVector&& other) : ti(other.ti), elements(other.elements), count(other.count), capacity(other.capacity) {
+        other.elements = nullptr;
+        other.count = 0;
+        other.capacity = 0;
+    }
+
+    ~AnyVector() {
+        clear();
+        free_aligned(elements);
+    }
+
+    inline const TypeInfo* type() const {
+        return ti;
+    }
+
+    inline size_t length() const {
+        return count;
+    }
+
+    void* data() {
+        return elements;
+    }
+
+    const void* data() const {
+        return elements;
+    }
+
+    void* operator[](size_t index) {
+        return elements + index * ti->size;
+    }
+
+    const void* operator[](size_t index) const {
+        return elements + index * ti->size;
+    }
+
+    // Returns false if the storage couldn't be allocated or the elements can't be moved or copied into it
+    bool reserve(size_t new_capacity) {
+        if (new_capacity <= capacity) return true;
+        if (!ti || ti->alignment == 0 || ti->size == 0) return false;
+
+        bool trivial = (ti->traits & TYPE_TRIVIALLY_COPYABLE) != 0;
+        bool relocatable = trivial || (ti->ops && (ti->ops->move || ti->ops->copy));
+        if (count > 0 && !relocatable) return false;
+
+        uint8_t* new_elements = (uint8_t*)allocate_aligned(new_capacity * ti->size, ti->alignment);
+        if (!new_elements) return false;
+
+        if (trivial) {
+            if (count > 0) memcpy(new_elements, elements, count * ti->size);
+        } else {
+            for (size_t i = 0; i < count; i++) {
+                move_value(ti, new_elements + i * ti->size, elements + i * ti->size);
+                destroy_value(ti, elements + i * ti->size);
+            }
+        }
+
+        free_aligned(elements);
+        elements = new_elements;
+        capacity = new_capacity;
+
+        return true;
+    }
+
+    // Appends a default constructed element, returns nullptr if it can't be constructed
+    void* push_back() {
+        if (!grow()) return nullptr;
+
+        void* element = elements + count * ti->size;
+        if (!construct_value(ti, element)) return nullptr;
+
+        count += 1;
+        return element;
+    }
+
+    // Appends a copy of `value`, which can't be an element of this vector.
+    // Returns nullptr if it can't be copied
+    void* push_back(const void* value) {
+        if (!grow()) return nullptr;
+
+        void* element = elements + count * ti->size;
+        if (!copy_value(ti, element, value)) return nullptr;
+
+        count += 1;
+        return element;
+    }
+
+    void pop_back() {
+        if (count == 0) return;
+
+        count -= 1;
+        destroy_value(ti, elements + count * ti->size);
+    }
+
+    void clear() {
+        if (count > 0 && !(ti->traits & TYPE_TRIVIALLY_DESTRUCTIBLE)) {
+            for (size_t i = 0; i < count; i++) {
+                destroy_value(ti, elements + i * ti->size);
+            }
+        }
+
+        count = 0;
+    }
+
+private:
+    bool grow() {
+        return count < capacity || reserve(capacity > 0 ? capacity * 2 : 8);
+    }
+
+    const TypeInfo* ti;
+    uint8_t* elements = nullptr;
+    size_t count = 0;
+    size_t capacity = 0;
+};
+)";
+
+static const char* compact_h = R"(
+// The hot part of a record, `first_field` indexes into the `COMPACT_FIELD_*` tables
+// and `first_leaf` into the `COMPACT_LEAF_*` tables
+struct CompactType {
+    uint32_t size;
+    uint32_t first_field;
+    uint32_t field_count;
+    uint32_t first_leaf;
+    uint32_t leaf_count;
+};
+
+// The parts of a field that aren't needed to walk over it
+struct CompactFieldCold {
+    const char* name;
+    uint8_t bit_width;
+    uint8_t bit_shift;
+    RecordAccess access;
+    int tag_count;
+    const char* const* tags;
+};
+
+// Some ancestors aren't on the first-parent chain, so the interval check isn't enough
+static const uint16_t HIERARCHY_MULTIPLE = 1 << 0;
+// Some ancestors aren't indexed (e.g. templates), so only a walk over the parents can rule a type out
+static const uint16_t HIERARCHY_PARTIAL = 1 << 1;
+// The type has a vtable
+static const uint16_t HIERARCHY_POLYMORPHIC = 1 << 2;
+
+// `pre` and `post` number the tree formed by the first parent of every type, a type derives from
+// another if its interval is nested inside the other's. `first_ancestor` indexes into `get_hierarchy_ancestors()`
+struct HierarchyNode {
+    uint32_t pre;
+    uint32_t post;
+    uint32_t first_ancestor;
+    uint16_t ancestor_count;
+    uint16_t flags;
+};
+
+// The offset is `UNKNOWN_OFFSET` for virtual, non-public and ambiguous bases
+struct HierarchyAncestor {
+    uint32_t type_index;
+    uint32_t offset;
+};
+)";
+
+static const char* compact_functions_h = R"(
+// Returns the compact type at `type_index`, nullptr if the index is out of range
+static const CompactType* get_compact_type(uint32_t type_index) {
+    if (type_index >= COMPACT_TYPE_COUNT) return nullptr;
+
+    return &COMPACT_TYPES[type_index];
+}
+
+static const CompactType* get_compact_type(const TypeInfo* ti) {
+    if (ti == nullptr) return nullptr;
+
+    return get_compact_type(ti->type_index);
+}
+
+template<typename T>
+static const CompactType* get_compact_type() {
+    return get_compact_type(type_of<T>());
+}
+
+// Returns the full type info at `type_index`, nullptr if the index is out of range
+static const TypeInfo* get_type_info(uint32_t type_index) {
+    if (type_index >= COMPACT_TYPE_COUNT) return nullptr;
+
+    return ALL_TYPES[type_index]();
+}
+
+// Returns the cold data of the `index`th field of `type`, nullptr if the index is out of range
+static const CompactFieldCold* get_compact_field_cold(const CompactType* type, uint32_t index) {
+    if (type == nullptr || index >= type->field_count) return nullptr;
+
+    return &COMPACT_FIELDS_COLD[type->first_field + index];
+}
+
+// Returns the field index within `type`, -1 if no field named `name` exists
+static int get_compact_field_index(const CompactType* type, const char* name) {
+    if (type == nullptr || name == nullptr) return -1;
+
+    for (uint32_t i = 0; i < type->field_count; i++) {
+        if (strcmp(COMPACT_FIELDS_COLD[type->first_field + i].name, name) == 0) {
+            return (int)i;
+        }
+    }
+
+    return -1;
+}
+
+// Returns the entry of `base_index` in the ancestors of `type_index`, nullptr if it isn't an indexed ancestor
+static const HierarchyAncestor* find_hierarchy_ancestor(uint32_t type_index, uint32_t base_index) {
+    if (type_index >= COMPACT_TYPE_COUNT) return nullptr;
+
+    const HierarchyAncestor* first = get_hierarchy_ancestors() + HIERARCHY_NODES[type_index].first_ancestor;
+    const HierarchyAncestor* last = first + HIERARCHY_NODES[type_index].ancestor_count;
+
+    while (first < last) {
+        const HierarchyAncestor* middle = first + (last - first) / 2;
+
+        if (middle->type_index == base_index) return middle;
+
+        if (middle->type_index < base_index) {
+            first = middle + 1;
+        } else {
+            last = middle;
+        }
+    }
+
+    return nullptr;
+}
+
+// Walks over the parents for types that aren't in the hierarchy tables, `offset` receives the offset of `base`
+static bool walk_parents(const TypeInfo* ti, const TypeInfo* base, uint32_t& offset) {
+    if (ti->type_id == base->type_id) {
+        offset = 0;
+        return true;
+    }
+
+    if (ti->type != TypeInfoType::Record) return false;
+
+    const TypeInfoRecord* tir = (const TypeInfoRecord*)ti;
+    for (int i = 0; i < tir->parent_count; i++) {
+        uint32_t parent_offset = 0;
+
+        if (walk_parents(tir->parents[i], base, parent_offset)) {
+            bool known = tir->parent_offsets[i] != UNKNOWN_OFFSET && parent_offset != UNKNOWN_OFFSET;
+            offset = known ? tir->parent_offsets[i] + parent_offset : UNKNOWN_OFFSET;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// Returns true if `ti` is `base` or derives from it, constant time for single inheritance
+static bool is_a(const TypeInfo* ti, const TypeInfo* base) {
+    if (ti == nullptr || base == nullptr) return false;
+    if (ti == base) return true;
+
+    if (ti->type_index < COMPACT_TYPE_COUNT && base->type_index < COMPACT_TYPE_COUNT) {
+        const HierarchyNode& node = HIERARCHY_NODES[ti->type_index];
+        const HierarchyNode& base_node = HIERARCHY_NODES[base->type_index];
+
+        if (base_node.pre <= node.pre && node.post <= base_node.post) return true;
+
+        if ((node.flags & HIERARCHY_MULTIPLE) && find_hierarchy_ancestor(ti->type_index, base->type_index)) {
+            return true;
+        }
+
+        if (!(node.flags & HIERARCHY_PARTIAL)) return false;
+    }
+
+    uint32_t offset = 0;
+    return walk_parents(ti, base, offset);
+}
+
+template<typename Base>
+static bool is_a(const TypeInfo* ti) {
+    return is_a(ti, type_of<Base>());
+}
+
+// Returns the offset of `base` inside of `ti`, `UNKNOWN_OFFSET` if `ti` doesn't derive from `base`
+// or the offset isn't known (e.g. virtual bases)
+static uint32_t get_base_offset(const TypeInfo* ti, const TypeInfo* base) {
+    if (ti == nullptr || base == nullptr) return UNKNOWN_OFFSET;
+    if (ti == base) return 0;
+
+    if (ti->type_index < COMPACT_TYPE_COUNT && base->type_index < COMPACT_TYPE_COUNT) {
+        if (ti->type_index == base->type_index) return 0;
+
+        const HierarchyAncestor* ancestor = find_hierarchy_ancestor(ti->type_index, base->type_index);
+        if (ancestor) return ancestor->offset;
+
+        if (!(HIERARCHY_NODES[ti->type_index].flags & HIERARCHY_PARTIAL)) return UNKNOWN_OFFSET;
+    }
+
+    uint32_t offset = 0;
+    return walk_parents(ti, base, offset) ? offset : UNKNOWN_OFFSET;
+}
+
+// Casts `ptr`, an object of type `ti`, to its `Base` part without RTTI.
+// Returns nullptr if `ti` doesn't derive from `Base` or the offset of `Base` isn't known
+template<typename Base>
+static Base* dyn_cast(void* ptr, const TypeInfo* ti) {
+    uint32_t offset = get_base_offset(ti, type_of<Base>());
+    if (ptr == nullptr || offset == UNKNOWN_OFFSET) return nullptr;
+
+    return (Base*)((char*)ptr + offset);
+}
+
+template<typename Base>
+static const Base* dyn_cast(const void* ptr, const TypeInfo* ti) {
+    return dyn_cast<Base>((void*)ptr, ti);
+}
+)";
+
+static const char* dynamic_h = R"(
+// A vtable of a generated type, `offset` is where the pointer to it is stored inside of the type
+struct DynamicTypeEntry {
+    const void* vtable;
+    uint32_t type_index;
+    uint32_t offset;
+};
+
+// Adds the vtable of `T` and those of its polymorphic bases that don't share it, only for types tagged `DynamicType`.
+// `T` is default constructed and destroyed once to read them, so types that can't be default constructed are left out.
+// This assumes the vtable pointer is stored at the start of every polymorphic (sub)object, which is true for the
+// Itanium (GCC, Clang) and MSVC ABIs but isn't guaranteed by the standard.
+// These and the table functions are `inline` instead of `static` so the table is only built once per program
+template<typename T>
+inline typename std::enable_if<std::is_polymorphic<T>::value && std::is_default_constructible<T>::value &&
+                               std::is_destructible<T>::value>::type
+add_dynamic_type(std::vector<DynamicTypeEntry>& entries, uint32_t type_index) {
+    // Constructed in place so `T` doesn't need a virtual destructor, with extra room for over-aligned types
+    char* memory = (char*)::operator new(sizeof(T) + alignof(T));
+    char* data = memory + (alignof(T) - (uintptr_t)memory % alignof(T)) % alignof(T);
+    T* object = new (data) T();
+
+    // The first polymorphic base shares the vtable pointer at the start of the object
+    entries.push_back({ *(const void* const*)data, type_index, 0 });
+
+    const HierarchyNode& node = HIERARCHY_NODES[type_index];
+    const HierarchyAncestor* ancestors = get_hierarchy_ancestors();
+    for (uint32_t i = 0; i < node.ancestor_count; i++) {
+        const HierarchyAncestor& ancestor = ancestors[node.first_ancestor + i];
+        bool polymorphic = (HIERARCHY_NODES[ancestor.type_index].flags & HIERARCHY_POLYMORPHIC) != 0;
+
+        if (polymorphic && ancestor.offset != 0 && ancestor.offset != UNKNOWN_OFFSET) {
+            entries.push_back({ *(const void* const*)(data + ancestor.offset), type_index, ancestor.offset });
+        }
+    }
+
+    object->~T();
+    ::operator delete(memory);
+}
+
+template<typename T>
+inline typename std::enable_if<!(std::is_polymorphic<T>::value && std::is_default_constructible<T>::value &&
+                                 std::is_destructible<T>::value)>::type
+add_dynamic_type(std::vector<DynamicTypeEntry>&, uint32_t) {}
+)";
+
+static const char* dynamic_functions_h = R"(
+// An open addressing table from vtable to type, kept at most half full
+struct DynamicTypeTable {
+    std::vector<DynamicTypeEntry> entries;
+    uint32_t mask;
+};
+
+// Vtables are aligned, so the low bits are mixed in with a multiplication
+inline uint32_t hash_vtable(const void* vtable) {
+    return (uint32_t)(((uint64_t)(uintptr_t)vtable * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+inline DynamicTypeTable build_dynamic_type_table() {
+    std::vector<DynamicTypeEntry> found;
+    add_all_dynamic_types(found);
+
+    uint32_t capacity = 16;
+    while (capacity < found.size() * 2) {
+        capacity *= 2;
+    }
+
+    DynamicTypeTable table;
+    table.entries.resize(capacity, DynamicTypeEntry{ nullptr, INVALID_TYPE_INDEX, 0 });
+    table.mask = capacity - 1;
+
+    for (auto& entry : found) {
+        uint32_t slot = hash_vtable(entry.vtable) & table.mask;
+
+        while (table.entries[slot].vtable != nullptr && table.entries[slot].vtable != entry.vtable) {
+            slot = (slot + 1) & table.mask;
+        }
+
+        if (table.entries[slot].vtable == nullptr) {
+            table.entries[slot] = entry;
+        }
+    }
+
+    return table;
+}
+
+// Built on first use, shared by every translation unit.
+// Never built during static initialization, not even with `TT_WARM_UP_ON_STARTUP`, because it runs user constructors
+inline const DynamicTypeTable& get_dynamic_type_table() {
+    static const DynamicTypeTable table = build_dynamic_type_table();
+    return table;
+}
+
+// Builds the table ahead of time, call it from `main` so the first `type_of_dynamic` doesn't have to
+static void warm_up_dynamic_types() {
+    get_dynamic_type_table();
+}
+
+// Returns the entry of the vtable `object` points to, nullptr if it isn't the vtable of a generated type
+static const DynamicTypeEntry* find_dynamic_type(const void* object) {
+    if (object == nullptr) return nullptr;
+
+    const void* vtable = *(const void* const*)object;
+    const DynamicTypeTable& table = get_dynamic_type_table();
+
+    uint32_t slot = hash_vtable(vtable) & table.mask;
+    while (table.entries[slot].vtable != nullptr) {
+        if (table.entries[slot].vtable == vtable) return &table.entries[slot];
+
+        slot = (slot + 1) & table.mask;
+    }
+
+    return nullptr;
+}
+
+// Returns the type info of the most-derived type of `object` without RTTI,
+// nullptr if that type isn't generated, isn't tagged `DynamicType` or couldn't be default constructed
+template<typename T>
+static const TypeInfo* type_of_dynamic(const T* object) {
+    static_assert(std::is_polymorphic<T>::value, "type_of_dynamic requires a polymorphic type");
+
+    const DynamicTypeEntry* entry = find_dynamic_type(object);
+    return entry ? get_type_info(entry->type_index) : nullptr;
+}
+
+// Returns the start of the most-derived object of `object`, which is what `dyn_cast` expects
+template<typename T>
+static const void* get_dynamic_object(const T* object) {
+    static_assert(std::is_polymorphic<T>::value, "get_dynamic_object requires a polymorphic type");
+
+    const DynamicTypeEntry* entry = find_dynamic_type(object);
+    return entry ? (const char*)object - entry->offset : nullptr;
+}
+
+template<typename T>
+static void* get_dynamic_object(T* object) {
+    return (void*)get_dynamic_object((const T*)object);
+}
+)";
+
+static const char* table_h = R"(
+// Every type refers to other types by their type index and to names by their offset in the string table,
+// so a table can be written to disk and used from another process as is
+struct TableType {
+    TypeInfoType type;
+    uint8_t subtype;       // The RecordType or IndirectType, if applicable
+    uint32_t name;         // The offset of the type name in the string table
+    type_id_t type_id;
+    uint32_t size;
+    uint32_t underlying;   // The type index of the underlying type of arrays, indirect types and enums
+    int64_t length;        // The length of arrays
+    uint32_t first_parent;
+    uint32_t parent_count;
+    uint32_t first_field;
+    uint32_t field_count;
+    uint32_t first_enum;
+    uint32_t enum_count;
+};
+
+struct TableParent {
+    uint32_t type_index;
+    uint32_t offset;
+};
+
+struct TableField {
+    uint32_t name;
+    uint32_t type_index;
+    uint32_t offset;
+    uint32_t size;         // 0 for bitfields and references
+    uint8_t bit_width;
+    uint8_t bit_shift;
+    RecordAccess access;
+};
+
+struct TableEnum {
+    uint32_t name;
+    int64_t value;
+};
+
+struct TypeTable {
+    const TableType* types;
+    uint32_t type_count;
+    const TableParent* parents;
+    uint32_t parent_count;
+    const TableField* fields;
+    uint32_t field_count;
+    const TableEnum* enums;
+    uint32_t enum_count;
+    const char* strings;
+    uint32_t strings_size;
+};
+)";
+
+static const char* table_functions_h = R"(
+// Returns the table of all generated types
+static TypeTable get_type_table() {
+    TypeTable table;
+    table.types = TYPE_TABLE_TYPES;
+    table.type_count = TYPE_TABLE_TYPE_COUNT;
+    table.parents = get_type_table_parents();
+    table.parent_count = TYPE_TABLE_PARENT_COUNT;
+    table.fields = TYPE_TABLE_FIELDS;
+    table.field_count = TYPE_TABLE_FIELD_COUNT;
+    table.enums = TYPE_TABLE_ENUMS;
+    table.enum_count = TYPE_TABLE_ENUM_COUNT;
+    table.strings = TYPE_TABLE_STRINGS;
+    table.strings_size = TYPE_TABLE_STRINGS_SIZE;
+    return table;
+}
+
+// Returns the type at `type_index`, nullptr if the index is out of range
+static const TableType* get_table_type(const TypeTable& table, uint32_t type_index) {
+    if (type_index >= table.type_count) return nullptr;
+
+    return &table.types[type_index];
+}
+
+static const TableType* get_table_type(const TypeTable& table, const TypeInfo* ti) {
+    if (ti == nullptr) return nullptr;
+
+    return get_table_type(table, ti->type_index);
+}
+
+template<typename T>
+static const TableType* get_table_type(const TypeTable& table) {
+    return get_table_type(table, type_of<T>());
+}
+
+// Returns the type index of the type with `type_id`, `INVALID_TYPE_INDEX` if it's not in the table
+static uint32_t find_table_type(const TypeTable& table, type_id_t type_id) {
+    for (uint32_t i = 0; i < table.type_count; i++) {
+        if (table.types[i].type_id == type_id) return i;
+    }
+
+    return INVALID_TYPE_INDEX;
+}
+
+// Returns the string at `offset`, nullptr if the offset is out of range
+static const char* get_table_string(const TypeTable& table, uint32_t offset) {
+    if (offset >= table.strings_size) return nullptr;
+
+    return table.strings + offset;
+}
+
+static Span<const TableParent> get_table_parents(const TypeTable& table, const TableType* type) {
+    if (type == nullptr || type->first_parent + type->parent_count > table.parent_count) {
+        return Span<const TableParent>(nullptr, 0);
+    }
+
+    return Span<const TableParent>(table.parents + type->first_parent, type->parent_count);
+}
+
+static Span<const TableField> get_table_fields(const TypeTable& table, const TableType* type) {
+    if (type == nullptr || type->first_field + type->field_count > table.field_count) {
+        return Span<const TableField>(nullptr, 0);
+    }
+
+    return Span<const TableField>(table.fields + type->first_field, type->field_count);
+}
+
+static Span<const TableEnum> get_table_enums(const TypeTable& table, const TableType* type) {
+    if (type == nullptr || type->first_enum + type->enum_count > table.enum_count) {
+        return Span<const TableEnum>(nullptr, 0);
+    }
+
+    return Span<const TableEnum>(table.enums + type->first_enum, type->enum_count);
+}
+)";